@@ -0,0 +1,190 @@
+// Sliding-window aggregation over rolling time windows for arbitrary associative operations
+// -) a monoid is a class with
+//      typedef ... value_type;                                    // type of the partial aggregates
+//      value_type identity() const;                               // aggregate of an empty window
+//      value_type combine(const value_type &older, const value_type &newer) const;   // associative
+//      value_type lift(double value) const;                       // aggregate of a single observation
+//      double result(const value_type &aggregate) const;          // output value of an aggregate
+//    where combine() need neither be commutative nor invertible, e.g. minimum, maximum, product, any or all
+// -) sliding_window_aggregator keeps the window in two stacks (Hirzel et al., 2017): the aggregates of each
+//    older observation and all newer observations of the older stack, and the running aggregate of the newer
+//    stack; when the older stack is empty, all observations are moved to it, so that each observation is
+//    combined a constant number of times, i.e. amortized O(1) per step
+// -) rolling_aggregate applies it to the rolling windows of the rolling_* kernels, so a new rolling operator
+//    only needs a monoid, e.g.
+//      struct gcd_monoid { ... };
+//      rolling_aggregate(values, times, &n, values_new, &width_before, &width_after, gcd_monoid());
+//    where the observation times and window widths can be doubles or 64-bit integers, see <RcppUTS/time_window.h>;
+//    rolling_aggregate_windows takes precomputed rolling windows instead of the times and widths
+
+#ifndef _RcppUTS_sliding_window_h
+#define _RcppUTS_sliding_window_h
+
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+
+#include <RcppUTS/time_window.h>
+
+// Queue of observations with the aggregate of all observations in it
+template <class Monoid>
+class sliding_window_aggregator {
+public:
+  typedef typename Monoid::value_type value_type;
+
+  sliding_window_aggregator(const Monoid &monoid = Monoid())
+    : monoid(monoid), back_aggregate(monoid.identity()) {}
+
+  // Add the newest observation
+  void push(const value_type &value) {
+    back.push_back(value);
+    back_aggregate = monoid.combine(back_aggregate, value);
+  }
+
+  // Remove the oldest observation, which must exist
+  void pop() {
+    if (front.empty())
+      flip();
+    front.pop_back();
+  }
+
+  // Aggregate of all observations, from the oldest to the newest
+  value_type query() const {
+    return front.empty() ? back_aggregate : monoid.combine(front.back(), back_aggregate);
+  }
+
+  size_t size() const { return front.size() + back.size(); }
+
+  void clear() {
+    front.clear();
+    back.clear();
+    back_aggregate = monoid.identity();
+  }
+
+private:
+  // Move all observations to the older stack, whose top is the oldest observation
+  void flip() {
+    value_type aggregate = monoid.identity();
+    for (size_t j = back.size(); j > 0; j--) {
+      aggregate = monoid.combine(back[j - 1], aggregate);
+      front.push_back(aggregate);
+    }
+    back.clear();
+    back_aggregate = monoid.identity();
+  }
+
+  Monoid monoid;
+  std::vector<value_type> front;   // aggregates of each older observation and all newer ones in 'front'
+  std::vector<value_type> back;    // newer observations, from the oldest to the newest
+  value_type back_aggregate;       // aggregate of all observations in 'back'
+};
+
+
+// Rolling aggregate of observation values for the monoid 'monoid', over windows given as an object
+template <class Monoid, class Windows>
+void rolling_aggregate_windows(double values[], ptrdiff_t *n, double values_new[], const Windows &windows,
+  const Monoid &monoid = Monoid())
+{
+  // values     ... array of time series values
+  // n          ... number of observations, i.e. length of 'values'
+  // values_new ... array of length *n to store output time series values
+  // windows    ... rolling windows of the observation times, e.g. time_windows, see <RcppUTS/time_window.h>
+  // monoid     ... associative operation, see above
+
+  ptrdiff_t left = 0, right = -1;
+  sliding_window_aggregator<Monoid> window(monoid);
+
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    // Expand window on the right, after the observations already excluded on the left, which a count limit
+    // on the right end can leave beyond it (see rolling_window_bounds_capped)
+    if (right < left - 1)
+      right = left - 1;
+    while ((right < *n - 1) && windows.includes_right(right + 1, i)) {
+      right++;
+      window.push(monoid.lift(values[right]));
+    }
+
+    // Shrink window on the left
+    while ((left < *n) && windows.excludes_left(left, i)) {
+      if (left <= right)
+        window.pop();
+      left++;
+    }
+
+    values_new[i] = monoid.result(window.query());
+  }
+}
+
+
+// Rolling aggregate of observation values for the monoid 'monoid'
+template <class Monoid, class Time>
+void rolling_aggregate(double values[], Time times[], ptrdiff_t *n, double values_new[],
+  Time *width_before, Time *width_after, const Monoid &monoid = Monoid())
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // monoid       ... associative operation, see above
+
+  rolling_aggregate_windows(values, n, values_new, time_windows<Time>(times, times, width_before, width_after), monoid);
+}
+
+
+// Monoids for common rolling operators
+
+struct sum_monoid {
+  typedef double value_type;
+  double identity() const { return 0; }
+  double combine(double older, double newer) const { return older + newer; }
+  double lift(double value) const { return value; }
+  double result(double aggregate) const { return aggregate; }
+};
+
+struct product_monoid {
+  typedef double value_type;
+  double identity() const { return 1; }
+  double combine(double older, double newer) const { return older * newer; }
+  double lift(double value) const { return value; }
+  double result(double aggregate) const { return aggregate; }
+};
+
+// Minimum, with +Inf for an empty window as for rolling_min
+struct min_monoid {
+  typedef double value_type;
+  double identity() const { return INFINITY; }
+  double combine(double older, double newer) const { return (newer < older) ? newer : older; }
+  double lift(double value) const { return value; }
+  double result(double aggregate) const { return aggregate; }
+};
+
+// Maximum, with -Inf for an empty window as for rolling_max
+struct max_monoid {
+  typedef double value_type;
+  double identity() const { return -INFINITY; }
+  double combine(double older, double newer) const { return (newer > older) ? newer : older; }
+  double lift(double value) const { return value; }
+  double result(double aggregate) const { return aggregate; }
+};
+
+// Whether any observation value is non-zero
+struct any_monoid {
+  typedef bool value_type;
+  bool identity() const { return false; }
+  bool combine(bool older, bool newer) const { return older || newer; }
+  bool lift(double value) const { return value != 0; }
+  double result(bool aggregate) const { return aggregate; }
+};
+
+// Whether all observation values are non-zero
+struct all_monoid {
+  typedef bool value_type;
+  bool identity() const { return true; }
+  bool combine(bool older, bool newer) const { return older && newer; }
+  bool lift(double value) const { return value != 0; }
+  double result(bool aggregate) const { return aggregate; }
+};
+
+#endif
@@ -0,0 +1,85 @@
+// Rolling window boundaries for double and integer observation times
+// -) the rolling window of time t is (t - width_before, t + width_after]; window_left_of(s, t, width_before) is
+//    true if time s lies at or before its left end, and window_right_of(s, t, width_after) if time s lies at or
+//    before its right end
+// -) for double times these are the comparisons of the rolling_* kernels, so that the results agree exactly
+// -) for 64-bit integer times, e.g. nanoseconds since the epoch, the comparisons use the exact difference of the
+//    two times instead of a shifted time, which cannot overflow for non-negative widths and times less than
+//    2^63 apart; a width of INT64_MAX stands for an infinite width
+// -) time_windows gives the rolling windows in the form used by the kernel templates, which only ask whether the
+//    window of the i-th output time reaches the observation at a position on the right, and whether it has passed
+//    the observation at a position on the left; other window classes with these two functions, e.g. windows
+//    precomputed once for many statistics, can be used in its place
+
+#ifndef _RcppUTS_time_window_h
+#define _RcppUTS_time_window_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+inline bool window_left_of(double s, double t, double width_before) {
+  return s <= t - width_before;
+}
+
+inline bool window_right_of(double s, double t, double width_after) {
+  return s <= t + width_after;
+}
+
+inline bool window_left_of(int64_t s, int64_t t, int64_t width_before) {
+  return t - s >= width_before;
+}
+
+inline bool window_right_of(int64_t s, int64_t t, int64_t width_after) {
+  return s - t <= width_after;
+}
+
+
+// Rolling windows of output times over observation times, optionally limited to the observations at positions
+// i - *n_before to i + *n_after as in rolling_window_bounds_capped (count limits require 'times_new' to be 'times')
+template <class Time>
+struct time_windows {
+  time_windows(Time *times, Time *times_new, Time *width_before, Time *width_after,
+               ptrdiff_t *n_before = NULL, ptrdiff_t *n_after = NULL)
+    : times(times), times_new(times_new), width_before(width_before), width_after(width_after),
+      n_before(n_before), n_after(n_after) {}
+
+  // Whether the window of output i extends to the observation at position 'pos' on the right
+  bool includes_right(ptrdiff_t pos, ptrdiff_t i) const {
+    return ((n_after == NULL) || (pos - i <= *n_after)) && window_right_of(times[pos], times_new[i], *width_after);
+  }
+
+  // Whether the window of output i starts after the observation at position 'pos'
+  bool excludes_left(ptrdiff_t pos, ptrdiff_t i) const {
+    return ((n_before != NULL) && (i - pos > *n_before)) || window_left_of(times[pos], times_new[i], *width_before);
+  }
+
+  Time *times, *times_new, *width_before, *width_after;
+  ptrdiff_t *n_before, *n_after;
+};
+
+
+// Positions of the first and last observation in each rolling window, as in rolling_window_bounds_capped
+// -) the left end stops at right + 1 for an empty window, also where a count limit holds back the right end
+template <class Windows>
+void window_bounds(const Windows &windows, ptrdiff_t *n, ptrdiff_t *n_new, ptrdiff_t left[], ptrdiff_t right[])
+{
+  // windows ... rolling windows, e.g. time_windows
+  // n       ... number of observations
+  // n_new   ... number of output times
+  // left    ... array of length *n_new to store the position of the first observation in each window
+  // right   ... array of length *n_new to store the position of the last observation in each window
+
+  ptrdiff_t l = 0, r = -1;
+
+  for (ptrdiff_t i = 0; i < *n_new; i++) {
+    while ((r < *n - 1) && windows.includes_right(r + 1, i))
+      r++;
+    while ((l <= r) && windows.excludes_left(l, i))
+      l++;
+    left[i] = l;
+    right[i] = r;
+  }
+}
+
+#endif
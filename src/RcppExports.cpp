@@ -1,243 +1,929 @@
 // Generated by using Rcpp::compileAttributes() -> do not edit by hand
 // Generator token: 10BE3573-1514-4C36-9D1C-5A225CD40393
 
+#include "RcppUTS_types.h"
 #include <Rcpp.h>
 
 using namespace Rcpp;
 
-// EMAnext
-Rcpp::NumericVector EMAnext(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double tau);
-RcppExport SEXP _RcppUTS_EMAnext(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP) {
+// asofSample
+Rcpp::NumericVector asofSample(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::DatetimeVector at, const std::string type, const double tolerance);
+RcppExport SEXP _RcppUTS_asofSample(SEXP timesSEXP, SEXP valuesSEXP, SEXP atSEXP, SEXP typeSEXP, SEXP toleranceSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type tau(tauSEXP);
-    rcpp_result_gen = Rcpp::wrap(EMAnext(times, values, tau));
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< const double >::type tolerance(toleranceSEXP);
+    rcpp_result_gen = Rcpp::wrap(asofSample(times, values, at, type, tolerance));
     return rcpp_result_gen;
 END_RCPP
 }
-// EMAlast
-Rcpp::NumericVector EMAlast(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double tau);
-RcppExport SEXP _RcppUTS_EMAlast(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP) {
+// asofIndex
+SEXP asofIndex(Rcpp::DatetimeVector times, Rcpp::DatetimeVector at, const std::string type, const double tolerance);
+RcppExport SEXP _RcppUTS_asofIndex(SEXP timesSEXP, SEXP atSEXP, SEXP typeSEXP, SEXP toleranceSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< const double >::type tolerance(toleranceSEXP);
+    rcpp_result_gen = Rcpp::wrap(asofIndex(times, at, type, tolerance));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAnext
+Rcpp::NumericVector EMAnext(SEXP times, Rcpp::NumericVector values, const TimeWidth tau, int threads, bool fast);
+RcppExport SEXP _RcppUTS_EMAnext(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP, SEXP threadsSEXP, SEXP fastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type tau(tauSEXP);
-    rcpp_result_gen = Rcpp::wrap(EMAlast(times, values, tau));
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type fast(fastSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAnext(times, values, tau, threads, fast));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAlast
+Rcpp::NumericVector EMAlast(SEXP times, Rcpp::NumericVector values, const TimeWidth tau, int threads, bool fast);
+RcppExport SEXP _RcppUTS_EMAlast(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP, SEXP threadsSEXP, SEXP fastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type fast(fastSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAlast(times, values, tau, threads, fast));
     return rcpp_result_gen;
 END_RCPP
 }
 // EMAlinear
-Rcpp::NumericVector EMAlinear(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double tau);
-RcppExport SEXP _RcppUTS_EMAlinear(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP) {
+Rcpp::NumericVector EMAlinear(SEXP times, Rcpp::NumericVector values, const TimeWidth tau, int threads, bool fast);
+RcppExport SEXP _RcppUTS_EMAlinear(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP, SEXP threadsSEXP, SEXP fastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type fast(fastSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAlinear(times, values, tau, threads, fast));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAnextMulti
+Rcpp::NumericMatrix EMAnextMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector tau);
+RcppExport SEXP _RcppUTS_EMAnextMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type tau(tauSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAnextMulti(times, values, tau));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAlastMulti
+Rcpp::NumericMatrix EMAlastMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector tau);
+RcppExport SEXP _RcppUTS_EMAlastMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type tau(tauSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAlastMulti(times, values, tau));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAlinearMulti
+Rcpp::NumericMatrix EMAlinearMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector tau);
+RcppExport SEXP _RcppUTS_EMAlinearMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type tau(tauSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAlinearMulti(times, values, tau));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAvar
+Rcpp::NumericVector EMAvar(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth tau, const std::string type);
+RcppExport SEXP _RcppUTS_EMAvar(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAvar(times, values, tau, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAsd
+Rcpp::NumericVector EMAsd(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth tau, const std::string type);
+RcppExport SEXP _RcppUTS_EMAsd(SEXP timesSEXP, SEXP valuesSEXP, SEXP tauSEXP, SEXP typeSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type tau(tauSEXP);
-    rcpp_result_gen = Rcpp::wrap(EMAlinear(times, values, tau));
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAsd(times, values, tau, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAcov
+Rcpp::NumericVector EMAcov(Rcpp::DatetimeVector timesx, Rcpp::NumericVector valuesx, Rcpp::DatetimeVector timesy, Rcpp::NumericVector valuesy, const TimeWidth tau, const std::string type);
+RcppExport SEXP _RcppUTS_EMAcov(SEXP timesxSEXP, SEXP valuesxSEXP, SEXP timesySEXP, SEXP valuesySEXP, SEXP tauSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesx(timesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesx(valuesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesy(timesySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesy(valuesySEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAcov(timesx, valuesx, timesy, valuesy, tau, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAcor
+Rcpp::NumericVector EMAcor(Rcpp::DatetimeVector timesx, Rcpp::NumericVector valuesx, Rcpp::DatetimeVector timesy, Rcpp::NumericVector valuesy, const TimeWidth tau, const std::string type);
+RcppExport SEXP _RcppUTS_EMAcor(SEXP timesxSEXP, SEXP valuesxSEXP, SEXP timesySEXP, SEXP valuesySEXP, SEXP tauSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesx(timesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesx(valuesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesy(timesySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesy(valuesySEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAcor(timesx, valuesx, timesy, valuesy, tau, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAat
+Rcpp::NumericVector EMAat(SEXP times, Rcpp::NumericVector values, SEXP at, const TimeWidth tau, const std::string type);
+RcppExport SEXP _RcppUTS_EMAat(SEXP timesSEXP, SEXP valuesSEXP, SEXP atSEXP, SEXP tauSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAat(times, values, at, tau, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// EMAinto
+SEXP EMAinto(SEXP times, SEXP values, SEXP out, const TimeWidth tau, const std::string type, bool fast);
+RcppExport SEXP _RcppUTS_EMAinto(SEXP timesSEXP, SEXP valuesSEXP, SEXP outSEXP, SEXP tauSEXP, SEXP typeSEXP, SEXP fastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type out(outSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type tau(tauSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< bool >::type fast(fastSEXP);
+    rcpp_result_gen = Rcpp::wrap(EMAinto(times, values, out, tau, type, fast));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingCentralMoment
-Rcpp::NumericVector rollingCentralMoment(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter, const double moment);
-RcppExport SEXP _RcppUTS_rollingCentralMoment(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP momentSEXP) {
+Rcpp::NumericVector rollingCentralMoment(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, const double moment, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingCentralMoment(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP momentSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
     Rcpp::traits::input_parameter< const double >::type moment(momentSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingCentralMoment(times, values, widthbefore, widthafter, moment));
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingCentralMoment(times, values, widthbefore, widthafter, moment, nbefore, nafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingKurtosis
+Rcpp::NumericVector rollingKurtosis(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingKurtosis(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingKurtosis(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingMax
-Rcpp::NumericVector rollingMax(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingMax(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingMax(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingMax(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingMax(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMax(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingMean
-Rcpp::NumericVector rollingMean(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingMean(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingMean(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingMean(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingMean(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMean(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingMedian
-Rcpp::NumericVector rollingMedian(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingMedian(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingMedian(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingMedian(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingMedian(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMedian(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingMin
-Rcpp::NumericVector rollingMin(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingMin(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingMin(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingMin(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingMin(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMin(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingNobs
-Rcpp::NumericVector rollingNobs(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingNobs(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingNobs(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingNobs(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingNobs(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingNobs(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingProduct
-Rcpp::NumericVector rollingProduct(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingProduct(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingProduct(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingProduct(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingProduct(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingLogProduct
+Rcpp::NumericVector rollingLogProduct(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingLogProduct(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingProduct(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingLogProduct(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingSD
-Rcpp::NumericVector rollingSD(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingSD(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingSD(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingSD(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingSD(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSD(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingSkewness
+Rcpp::NumericVector rollingSkewness(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingSkewness(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSkewness(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingSum
-Rcpp::NumericVector rollingSum(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingSum(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingSum(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingSum(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingSum(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSum(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingSumStable
-Rcpp::NumericVector rollingSumStable(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingSumStable(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingSumStable(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingSumStable(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingSumStable(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSumStable(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
 // rollingVar
-Rcpp::NumericVector rollingVar(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_rollingVar(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector rollingVar(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingVar(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(rollingVar(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingVar(times, values, widthbefore, widthafter, threads, grain, nbefore, nafter));
     return rcpp_result_gen;
 END_RCPP
 }
-// SMAnext
-Rcpp::NumericVector SMAnext(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_SMAnext(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+// rollingMeanMatrix
+Rcpp::NumericMatrix rollingMeanMatrix(Rcpp::DatetimeVector times, Rcpp::NumericMatrix values, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_rollingMeanMatrix(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMeanMatrix(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingSumMatrix
+Rcpp::NumericMatrix rollingSumMatrix(Rcpp::DatetimeVector times, Rcpp::NumericMatrix values, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_rollingSumMatrix(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSumMatrix(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingMatrix
+Rcpp::NumericMatrix rollingMatrix(Rcpp::DatetimeVector times, Rcpp::NumericMatrix values, const TimeWidth widthbefore, const TimeWidth widthafter, const std::string stat);
+RcppExport SEXP _RcppUTS_rollingMatrix(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP statSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type stat(statSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMatrix(times, values, widthbefore, widthafter, stat));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingMeanMulti
+Rcpp::NumericMatrix rollingMeanMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector widthbefore, Rcpp::NumericVector widthafter);
+RcppExport SEXP _RcppUTS_rollingMeanMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(SMAnext(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingMeanMulti(times, values, widthbefore, widthafter));
     return rcpp_result_gen;
 END_RCPP
 }
-// SMAlast
-Rcpp::NumericVector SMAlast(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_SMAlast(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+// rollingSDMulti
+Rcpp::NumericMatrix rollingSDMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector widthbefore, Rcpp::NumericVector widthafter);
+RcppExport SEXP _RcppUTS_rollingSDMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(SMAlast(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSDMulti(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingSummary
+Rcpp::NumericMatrix rollingSummary(SEXP times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, Rcpp::CharacterVector stats, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingSummary(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP statsSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSummary(times, values, widthbefore, widthafter, stats, nbefore, nafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingSummaryAt
+Rcpp::NumericMatrix rollingSummaryAt(SEXP times, Rcpp::NumericVector values, SEXP at, const TimeWidth widthbefore, const TimeWidth widthafter, Rcpp::CharacterVector stats);
+RcppExport SEXP _RcppUTS_rollingSummaryAt(SEXP timesSEXP, SEXP valuesSEXP, SEXP atSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP statsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSummaryAt(times, values, at, widthbefore, widthafter, stats));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingAt
+Rcpp::NumericVector rollingAt(SEXP times, Rcpp::NumericVector values, SEXP at, const TimeWidth widthbefore, const TimeWidth widthafter, const std::string stat);
+RcppExport SEXP _RcppUTS_rollingAt(SEXP timesSEXP, SEXP valuesSEXP, SEXP atSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP statSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type stat(statSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingAt(times, values, at, widthbefore, widthafter, stat));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingQuantileAt
+Rcpp::NumericMatrix rollingQuantileAt(SEXP times, Rcpp::NumericVector values, SEXP at, const TimeWidth widthbefore, const TimeWidth widthafter, Rcpp::NumericVector probs, int type);
+RcppExport SEXP _RcppUTS_rollingQuantileAt(SEXP timesSEXP, SEXP valuesSEXP, SEXP atSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP probsSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< int >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingQuantileAt(times, values, at, widthbefore, widthafter, probs, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingCov
+Rcpp::NumericVector rollingCov(Rcpp::DatetimeVector timesx, Rcpp::NumericVector valuesx, Rcpp::DatetimeVector timesy, Rcpp::NumericVector valuesy, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_rollingCov(SEXP timesxSEXP, SEXP valuesxSEXP, SEXP timesySEXP, SEXP valuesySEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesx(timesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesx(valuesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesy(timesySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesy(valuesySEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingCov(timesx, valuesx, timesy, valuesy, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingCor
+Rcpp::NumericVector rollingCor(Rcpp::DatetimeVector timesx, Rcpp::NumericVector valuesx, Rcpp::DatetimeVector timesy, Rcpp::NumericVector valuesy, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_rollingCor(SEXP timesxSEXP, SEXP valuesxSEXP, SEXP timesySEXP, SEXP valuesySEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesx(timesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesx(valuesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesy(timesySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesy(valuesySEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingCor(timesx, valuesx, timesy, valuesy, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingBeta
+Rcpp::NumericVector rollingBeta(Rcpp::DatetimeVector timesx, Rcpp::NumericVector valuesx, Rcpp::DatetimeVector timesy, Rcpp::NumericVector valuesy, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_rollingBeta(SEXP timesxSEXP, SEXP valuesxSEXP, SEXP timesySEXP, SEXP valuesySEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesx(timesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesx(valuesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type timesy(timesySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesy(valuesySEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingBeta(timesx, valuesx, timesy, valuesy, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingQuantile
+Rcpp::NumericMatrix rollingQuantile(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, Rcpp::NumericVector probs, int type, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_rollingQuantile(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP probsSEXP, SEXP typeSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< int >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingQuantile(times, values, widthbefore, widthafter, probs, type, nbefore, nafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingQuantileApprox
+Rcpp::NumericMatrix rollingQuantileApprox(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, Rcpp::NumericVector probs, double compression, int buckets);
+RcppExport SEXP _RcppUTS_rollingQuantileApprox(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP probsSEXP, SEXP compressionSEXP, SEXP bucketsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< double >::type compression(compressionSEXP);
+    Rcpp::traits::input_parameter< int >::type buckets(bucketsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingQuantileApprox(times, values, widthbefore, widthafter, probs, compression, buckets));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingAggregate
+Rcpp::NumericVector rollingAggregate(SEXP times, Rcpp::NumericVector values, TimeWidth widthbefore, TimeWidth widthafter, const std::string op);
+RcppExport SEXP _RcppUTS_rollingAggregate(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP opSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type op(opSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingAggregate(times, values, widthbefore, widthafter, op));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingInto
+SEXP rollingInto(SEXP times, SEXP values, SEXP out, TimeWidth widthbefore, TimeWidth widthafter, const std::string stat, int threads, int grain);
+RcppExport SEXP _RcppUTS_rollingInto(SEXP timesSEXP, SEXP valuesSEXP, SEXP outSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP statSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type out(outSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingInto(times, values, out, widthbefore, widthafter, stat, threads, grain));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAnext
+Rcpp::NumericVector SMAnext(SEXP times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain);
+RcppExport SEXP _RcppUTS_SMAnext(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAnext(times, values, widthbefore, widthafter, threads, grain));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAlast
+Rcpp::NumericVector SMAlast(SEXP times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain);
+RcppExport SEXP _RcppUTS_SMAlast(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAlast(times, values, widthbefore, widthafter, threads, grain));
     return rcpp_result_gen;
 END_RCPP
 }
 // SMAlinear
-Rcpp::NumericVector SMAlinear(Rcpp::DatetimeVector times, Rcpp::NumericVector values, const double widthbefore, const double widthafter);
-RcppExport SEXP _RcppUTS_SMAlinear(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+Rcpp::NumericVector SMAlinear(SEXP times, Rcpp::NumericVector values, const TimeWidth widthbefore, const TimeWidth widthafter, int threads, int grain);
+RcppExport SEXP _RcppUTS_SMAlinear(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAlinear(times, values, widthbefore, widthafter, threads, grain));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAnextMatrix
+Rcpp::NumericMatrix SMAnextMatrix(Rcpp::DatetimeVector times, Rcpp::NumericMatrix values, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_SMAnextMatrix(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAnextMatrix(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAlastMatrix
+Rcpp::NumericMatrix SMAlastMatrix(Rcpp::DatetimeVector times, Rcpp::NumericMatrix values, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_SMAlastMatrix(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAlastMatrix(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAlinearMatrix
+Rcpp::NumericMatrix SMAlinearMatrix(Rcpp::DatetimeVector times, Rcpp::NumericMatrix values, const TimeWidth widthbefore, const TimeWidth widthafter);
+RcppExport SEXP _RcppUTS_SMAlinearMatrix(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAlinearMatrix(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAnextMulti
+Rcpp::NumericMatrix SMAnextMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector widthbefore, Rcpp::NumericVector widthafter);
+RcppExport SEXP _RcppUTS_SMAnextMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthbefore(widthbeforeSEXP);
-    Rcpp::traits::input_parameter< const double >::type widthafter(widthafterSEXP);
-    rcpp_result_gen = Rcpp::wrap(SMAlinear(times, values, widthbefore, widthafter));
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAnextMulti(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAlastMulti
+Rcpp::NumericMatrix SMAlastMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector widthbefore, Rcpp::NumericVector widthafter);
+RcppExport SEXP _RcppUTS_SMAlastMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAlastMulti(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAlinearMulti
+Rcpp::NumericMatrix SMAlinearMulti(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::NumericVector widthbefore, Rcpp::NumericVector widthafter);
+RcppExport SEXP _RcppUTS_SMAlinearMulti(SEXP timesSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type widthafter(widthafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAlinearMulti(times, values, widthbefore, widthafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAat
+Rcpp::NumericVector SMAat(Rcpp::DatetimeVector times, Rcpp::NumericVector values, Rcpp::DatetimeVector at, const TimeWidth widthbefore, const TimeWidth widthafter, const std::string type);
+RcppExport SEXP _RcppUTS_SMAat(SEXP timesSEXP, SEXP valuesSEXP, SEXP atSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type at(atSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< const TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAat(times, values, at, widthbefore, widthafter, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAinto
+SEXP SMAinto(SEXP times, SEXP values, SEXP out, TimeWidth widthbefore, TimeWidth widthafter, const std::string type, int threads, int grain);
+RcppExport SEXP _RcppUTS_SMAinto(SEXP timesSEXP, SEXP valuesSEXP, SEXP outSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP typeSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type out(outSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAinto(times, values, out, widthbefore, widthafter, type, threads, grain));
+    return rcpp_result_gen;
+END_RCPP
+}
+// streamOperator
+Rcpp::XPtr<streaming_operator> streamOperator(const std::string type, const double param);
+RcppExport SEXP _RcppUTS_streamOperator(SEXP typeSEXP, SEXP paramSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< const double >::type param(paramSEXP);
+    rcpp_result_gen = Rcpp::wrap(streamOperator(type, param));
+    return rcpp_result_gen;
+END_RCPP
+}
+// streamPush
+Rcpp::NumericVector streamPush(Rcpp::XPtr<streaming_operator> op, Rcpp::DatetimeVector times, Rcpp::NumericVector values);
+RcppExport SEXP _RcppUTS_streamPush(SEXP opSEXP, SEXP timesSEXP, SEXP valuesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<streaming_operator> >::type op(opSEXP);
+    Rcpp::traits::input_parameter< Rcpp::DatetimeVector >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    rcpp_result_gen = Rcpp::wrap(streamPush(op, times, values));
+    return rcpp_result_gen;
+END_RCPP
+}
+// streamSave
+Rcpp::RawVector streamSave(Rcpp::XPtr<streaming_operator> op);
+RcppExport SEXP _RcppUTS_streamSave(SEXP opSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<streaming_operator> >::type op(opSEXP);
+    rcpp_result_gen = Rcpp::wrap(streamSave(op));
+    return rcpp_result_gen;
+END_RCPP
+}
+// streamLoad
+Rcpp::XPtr<streaming_operator> streamLoad(Rcpp::RawVector state);
+RcppExport SEXP _RcppUTS_streamLoad(SEXP stateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::RawVector >::type state(stateSEXP);
+    rcpp_result_gen = Rcpp::wrap(streamLoad(state));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -250,26 +936,273 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// timeIndex
+TimeIndex timeIndex(SEXP times);
+RcppExport SEXP _RcppUTS_timeIndex(SEXP timesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    rcpp_result_gen = Rcpp::wrap(timeIndex(times));
+    return rcpp_result_gen;
+END_RCPP
+}
+// timeIndexInfo
+Rcpp::List timeIndexInfo(TimeIndex index);
+RcppExport SEXP _RcppUTS_timeIndexInfo(SEXP indexSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< TimeIndex >::type index(indexSEXP);
+    rcpp_result_gen = Rcpp::wrap(timeIndexInfo(index));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingIndexed
+Rcpp::NumericVector rollingIndexed(TimeIndex index, Rcpp::NumericVector values, TimeWidth widthbefore, TimeWidth widthafter, const std::string stat, int threads, int grain);
+RcppExport SEXP _RcppUTS_rollingIndexed(SEXP indexSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP statSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< TimeIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingIndexed(index, values, widthbefore, widthafter, stat, threads, grain));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAindexed
+Rcpp::NumericVector SMAindexed(TimeIndex index, Rcpp::NumericVector values, TimeWidth widthbefore, TimeWidth widthafter, const std::string type, int threads, int grain);
+RcppExport SEXP _RcppUTS_SMAindexed(SEXP indexSEXP, SEXP valuesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP typeSEXP, SEXP threadsSEXP, SEXP grainSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< TimeIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type grain(grainSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAindexed(index, values, widthbefore, widthafter, type, threads, grain));
+    return rcpp_result_gen;
+END_RCPP
+}
+// windowIndex
+WindowIndex windowIndex(SEXP times, TimeWidth widthbefore, TimeWidth widthafter, const double nbefore, const double nafter);
+RcppExport SEXP _RcppUTS_windowIndex(SEXP timesSEXP, SEXP widthbeforeSEXP, SEXP widthafterSEXP, SEXP nbeforeSEXP, SEXP nafterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthbefore(widthbeforeSEXP);
+    Rcpp::traits::input_parameter< TimeWidth >::type widthafter(widthafterSEXP);
+    Rcpp::traits::input_parameter< const double >::type nbefore(nbeforeSEXP);
+    Rcpp::traits::input_parameter< const double >::type nafter(nafterSEXP);
+    rcpp_result_gen = Rcpp::wrap(windowIndex(times, widthbefore, widthafter, nbefore, nafter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// windowIndexInfo
+Rcpp::List windowIndexInfo(WindowIndex index);
+RcppExport SEXP _RcppUTS_windowIndexInfo(SEXP indexSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    rcpp_result_gen = Rcpp::wrap(windowIndexInfo(index));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingSummaryWindowed
+Rcpp::NumericMatrix rollingSummaryWindowed(WindowIndex index, Rcpp::NumericVector values, Rcpp::CharacterVector stats);
+RcppExport SEXP _RcppUTS_rollingSummaryWindowed(SEXP indexSEXP, SEXP valuesSEXP, SEXP statsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingSummaryWindowed(index, values, stats));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingAggregateWindowed
+Rcpp::NumericVector rollingAggregateWindowed(WindowIndex index, Rcpp::NumericVector values, const std::string op);
+RcppExport SEXP _RcppUTS_rollingAggregateWindowed(SEXP indexSEXP, SEXP valuesSEXP, SEXP opSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type op(opSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingAggregateWindowed(index, values, op));
+    return rcpp_result_gen;
+END_RCPP
+}
+// SMAwindowed
+Rcpp::NumericVector SMAwindowed(WindowIndex index, SEXP times, Rcpp::NumericVector values, const std::string type);
+RcppExport SEXP _RcppUTS_SMAwindowed(SEXP indexSEXP, SEXP timesSEXP, SEXP valuesSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(SMAwindowed(index, times, values, type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingWindowed
+Rcpp::NumericVector rollingWindowed(WindowIndex index, Rcpp::NumericVector values, const std::string stat);
+RcppExport SEXP _RcppUTS_rollingWindowed(SEXP indexSEXP, SEXP valuesSEXP, SEXP statSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type stat(statSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingWindowed(index, values, stat));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingCentralMomentWindowed
+Rcpp::NumericVector rollingCentralMomentWindowed(WindowIndex index, Rcpp::NumericVector values, const double moment);
+RcppExport SEXP _RcppUTS_rollingCentralMomentWindowed(SEXP indexSEXP, SEXP valuesSEXP, SEXP momentSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const double >::type moment(momentSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingCentralMomentWindowed(index, values, moment));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingQuantileWindowed
+Rcpp::NumericMatrix rollingQuantileWindowed(WindowIndex index, Rcpp::NumericVector values, Rcpp::NumericVector probs, int quantiletype);
+RcppExport SEXP _RcppUTS_rollingQuantileWindowed(SEXP indexSEXP, SEXP valuesSEXP, SEXP probsSEXP, SEXP quantiletypeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< int >::type quantiletype(quantiletypeSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingQuantileWindowed(index, values, probs, quantiletype));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingQuantileApproxWindowed
+Rcpp::NumericMatrix rollingQuantileApproxWindowed(WindowIndex index, Rcpp::NumericVector values, Rcpp::NumericVector probs, double compression, int buckets);
+RcppExport SEXP _RcppUTS_rollingQuantileApproxWindowed(SEXP indexSEXP, SEXP valuesSEXP, SEXP probsSEXP, SEXP compressionSEXP, SEXP bucketsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< double >::type compression(compressionSEXP);
+    Rcpp::traits::input_parameter< int >::type buckets(bucketsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingQuantileApproxWindowed(index, values, probs, compression, buckets));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rollingPairWindowed
+Rcpp::NumericVector rollingPairWindowed(WindowIndex index, Rcpp::NumericVector valuesx, Rcpp::NumericVector valuesy, const std::string stat);
+RcppExport SEXP _RcppUTS_rollingPairWindowed(SEXP indexSEXP, SEXP valuesxSEXP, SEXP valuesySEXP, SEXP statSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< WindowIndex >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesx(valuesxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type valuesy(valuesySEXP);
+    Rcpp::traits::input_parameter< const std::string >::type stat(statSEXP);
+    rcpp_result_gen = Rcpp::wrap(rollingPairWindowed(index, valuesx, valuesy, stat));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_RcppUTS_EMAnext", (DL_FUNC) &_RcppUTS_EMAnext, 3},
-    {"_RcppUTS_EMAlast", (DL_FUNC) &_RcppUTS_EMAlast, 3},
-    {"_RcppUTS_EMAlinear", (DL_FUNC) &_RcppUTS_EMAlinear, 3},
-    {"_RcppUTS_rollingCentralMoment", (DL_FUNC) &_RcppUTS_rollingCentralMoment, 5},
-    {"_RcppUTS_rollingMax", (DL_FUNC) &_RcppUTS_rollingMax, 4},
-    {"_RcppUTS_rollingMean", (DL_FUNC) &_RcppUTS_rollingMean, 4},
-    {"_RcppUTS_rollingMedian", (DL_FUNC) &_RcppUTS_rollingMedian, 4},
-    {"_RcppUTS_rollingMin", (DL_FUNC) &_RcppUTS_rollingMin, 4},
-    {"_RcppUTS_rollingNobs", (DL_FUNC) &_RcppUTS_rollingNobs, 4},
-    {"_RcppUTS_rollingProduct", (DL_FUNC) &_RcppUTS_rollingProduct, 4},
-    {"_RcppUTS_rollingSD", (DL_FUNC) &_RcppUTS_rollingSD, 4},
-    {"_RcppUTS_rollingSum", (DL_FUNC) &_RcppUTS_rollingSum, 4},
-    {"_RcppUTS_rollingSumStable", (DL_FUNC) &_RcppUTS_rollingSumStable, 4},
-    {"_RcppUTS_rollingVar", (DL_FUNC) &_RcppUTS_rollingVar, 4},
-    {"_RcppUTS_SMAnext", (DL_FUNC) &_RcppUTS_SMAnext, 4},
-    {"_RcppUTS_SMAlast", (DL_FUNC) &_RcppUTS_SMAlast, 4},
-    {"_RcppUTS_SMAlinear", (DL_FUNC) &_RcppUTS_SMAlinear, 4},
+    {"_RcppUTS_asofSample", (DL_FUNC) &_RcppUTS_asofSample, 5},
+    {"_RcppUTS_asofIndex", (DL_FUNC) &_RcppUTS_asofIndex, 4},
+    {"_RcppUTS_EMAnext", (DL_FUNC) &_RcppUTS_EMAnext, 5},
+    {"_RcppUTS_EMAlast", (DL_FUNC) &_RcppUTS_EMAlast, 5},
+    {"_RcppUTS_EMAlinear", (DL_FUNC) &_RcppUTS_EMAlinear, 5},
+    {"_RcppUTS_EMAnextMulti", (DL_FUNC) &_RcppUTS_EMAnextMulti, 3},
+    {"_RcppUTS_EMAlastMulti", (DL_FUNC) &_RcppUTS_EMAlastMulti, 3},
+    {"_RcppUTS_EMAlinearMulti", (DL_FUNC) &_RcppUTS_EMAlinearMulti, 3},
+    {"_RcppUTS_EMAvar", (DL_FUNC) &_RcppUTS_EMAvar, 4},
+    {"_RcppUTS_EMAsd", (DL_FUNC) &_RcppUTS_EMAsd, 4},
+    {"_RcppUTS_EMAcov", (DL_FUNC) &_RcppUTS_EMAcov, 6},
+    {"_RcppUTS_EMAcor", (DL_FUNC) &_RcppUTS_EMAcor, 6},
+    {"_RcppUTS_EMAat", (DL_FUNC) &_RcppUTS_EMAat, 5},
+    {"_RcppUTS_EMAinto", (DL_FUNC) &_RcppUTS_EMAinto, 6},
+    {"_RcppUTS_rollingCentralMoment", (DL_FUNC) &_RcppUTS_rollingCentralMoment, 7},
+    {"_RcppUTS_rollingKurtosis", (DL_FUNC) &_RcppUTS_rollingKurtosis, 8},
+    {"_RcppUTS_rollingMax", (DL_FUNC) &_RcppUTS_rollingMax, 8},
+    {"_RcppUTS_rollingMean", (DL_FUNC) &_RcppUTS_rollingMean, 8},
+    {"_RcppUTS_rollingMedian", (DL_FUNC) &_RcppUTS_rollingMedian, 8},
+    {"_RcppUTS_rollingMin", (DL_FUNC) &_RcppUTS_rollingMin, 8},
+    {"_RcppUTS_rollingNobs", (DL_FUNC) &_RcppUTS_rollingNobs, 8},
+    {"_RcppUTS_rollingProduct", (DL_FUNC) &_RcppUTS_rollingProduct, 8},
+    {"_RcppUTS_rollingLogProduct", (DL_FUNC) &_RcppUTS_rollingLogProduct, 8},
+    {"_RcppUTS_rollingSD", (DL_FUNC) &_RcppUTS_rollingSD, 8},
+    {"_RcppUTS_rollingSkewness", (DL_FUNC) &_RcppUTS_rollingSkewness, 8},
+    {"_RcppUTS_rollingSum", (DL_FUNC) &_RcppUTS_rollingSum, 8},
+    {"_RcppUTS_rollingSumStable", (DL_FUNC) &_RcppUTS_rollingSumStable, 8},
+    {"_RcppUTS_rollingVar", (DL_FUNC) &_RcppUTS_rollingVar, 8},
+    {"_RcppUTS_rollingMeanMatrix", (DL_FUNC) &_RcppUTS_rollingMeanMatrix, 4},
+    {"_RcppUTS_rollingSumMatrix", (DL_FUNC) &_RcppUTS_rollingSumMatrix, 4},
+    {"_RcppUTS_rollingMatrix", (DL_FUNC) &_RcppUTS_rollingMatrix, 5},
+    {"_RcppUTS_rollingMeanMulti", (DL_FUNC) &_RcppUTS_rollingMeanMulti, 4},
+    {"_RcppUTS_rollingSDMulti", (DL_FUNC) &_RcppUTS_rollingSDMulti, 4},
+    {"_RcppUTS_rollingSummary", (DL_FUNC) &_RcppUTS_rollingSummary, 7},
+    {"_RcppUTS_rollingSummaryAt", (DL_FUNC) &_RcppUTS_rollingSummaryAt, 6},
+    {"_RcppUTS_rollingAt", (DL_FUNC) &_RcppUTS_rollingAt, 6},
+    {"_RcppUTS_rollingQuantileAt", (DL_FUNC) &_RcppUTS_rollingQuantileAt, 7},
+    {"_RcppUTS_rollingCov", (DL_FUNC) &_RcppUTS_rollingCov, 6},
+    {"_RcppUTS_rollingCor", (DL_FUNC) &_RcppUTS_rollingCor, 6},
+    {"_RcppUTS_rollingBeta", (DL_FUNC) &_RcppUTS_rollingBeta, 6},
+    {"_RcppUTS_rollingQuantile", (DL_FUNC) &_RcppUTS_rollingQuantile, 8},
+    {"_RcppUTS_rollingQuantileApprox", (DL_FUNC) &_RcppUTS_rollingQuantileApprox, 7},
+    {"_RcppUTS_rollingAggregate", (DL_FUNC) &_RcppUTS_rollingAggregate, 5},
+    {"_RcppUTS_rollingInto", (DL_FUNC) &_RcppUTS_rollingInto, 8},
+    {"_RcppUTS_SMAnext", (DL_FUNC) &_RcppUTS_SMAnext, 6},
+    {"_RcppUTS_SMAlast", (DL_FUNC) &_RcppUTS_SMAlast, 6},
+    {"_RcppUTS_SMAlinear", (DL_FUNC) &_RcppUTS_SMAlinear, 6},
+    {"_RcppUTS_SMAnextMatrix", (DL_FUNC) &_RcppUTS_SMAnextMatrix, 4},
+    {"_RcppUTS_SMAlastMatrix", (DL_FUNC) &_RcppUTS_SMAlastMatrix, 4},
+    {"_RcppUTS_SMAlinearMatrix", (DL_FUNC) &_RcppUTS_SMAlinearMatrix, 4},
+    {"_RcppUTS_SMAnextMulti", (DL_FUNC) &_RcppUTS_SMAnextMulti, 4},
+    {"_RcppUTS_SMAlastMulti", (DL_FUNC) &_RcppUTS_SMAlastMulti, 4},
+    {"_RcppUTS_SMAlinearMulti", (DL_FUNC) &_RcppUTS_SMAlinearMulti, 4},
+    {"_RcppUTS_SMAat", (DL_FUNC) &_RcppUTS_SMAat, 6},
+    {"_RcppUTS_SMAinto", (DL_FUNC) &_RcppUTS_SMAinto, 8},
+    {"_RcppUTS_streamOperator", (DL_FUNC) &_RcppUTS_streamOperator, 2},
+    {"_RcppUTS_streamPush", (DL_FUNC) &_RcppUTS_streamPush, 3},
+    {"_RcppUTS_streamSave", (DL_FUNC) &_RcppUTS_streamSave, 1},
+    {"_RcppUTS_streamLoad", (DL_FUNC) &_RcppUTS_streamLoad, 1},
     {"_RcppUTS_utsExample", (DL_FUNC) &_RcppUTS_utsExample, 0},
+    {"_RcppUTS_timeIndex", (DL_FUNC) &_RcppUTS_timeIndex, 1},
+    {"_RcppUTS_timeIndexInfo", (DL_FUNC) &_RcppUTS_timeIndexInfo, 1},
+    {"_RcppUTS_rollingIndexed", (DL_FUNC) &_RcppUTS_rollingIndexed, 7},
+    {"_RcppUTS_SMAindexed", (DL_FUNC) &_RcppUTS_SMAindexed, 7},
+    {"_RcppUTS_windowIndex", (DL_FUNC) &_RcppUTS_windowIndex, 5},
+    {"_RcppUTS_windowIndexInfo", (DL_FUNC) &_RcppUTS_windowIndexInfo, 1},
+    {"_RcppUTS_rollingSummaryWindowed", (DL_FUNC) &_RcppUTS_rollingSummaryWindowed, 3},
+    {"_RcppUTS_rollingAggregateWindowed", (DL_FUNC) &_RcppUTS_rollingAggregateWindowed, 3},
+    {"_RcppUTS_SMAwindowed", (DL_FUNC) &_RcppUTS_SMAwindowed, 4},
+    {"_RcppUTS_rollingWindowed", (DL_FUNC) &_RcppUTS_rollingWindowed, 3},
+    {"_RcppUTS_rollingCentralMomentWindowed", (DL_FUNC) &_RcppUTS_rollingCentralMomentWindowed, 3},
+    {"_RcppUTS_rollingQuantileWindowed", (DL_FUNC) &_RcppUTS_rollingQuantileWindowed, 4},
+    {"_RcppUTS_rollingQuantileApproxWindowed", (DL_FUNC) &_RcppUTS_rollingQuantileApproxWindowed, 5},
+    {"_RcppUTS_rollingPairWindowed", (DL_FUNC) &_RcppUTS_rollingPairWindowed, 4},
     {NULL, NULL, 0}
 };
 
@@ -0,0 +1,29 @@
+#ifndef _RcppUTS_types_h
+#define _RcppUTS_types_h
+
+#include <Rcpp.h>
+#include "int64_times.h"
+#include "streaming.h"
+
+extern "C" {
+#include "time_index.h"
+#include "window_index.h"
+}
+
+// Release a time index owned by an external pointer
+inline void time_index_finalizer(time_index *index) {
+  time_index_free(index);
+  delete index;
+}
+
+typedef Rcpp::XPtr<time_index, Rcpp::PreserveStorage, time_index_finalizer> TimeIndex;
+
+// Release a window index owned by an external pointer
+inline void window_index_finalizer(window_index *index) {
+  window_index_free(index);
+  delete index;
+}
+
+typedef Rcpp::XPtr<window_index, Rcpp::PreserveStorage, window_index_finalizer> WindowIndex;
+
+#endif
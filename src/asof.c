@@ -0,0 +1,166 @@
+// License: GPL-2 | GPL-3
+
+#include <math.h>
+#include "asof.h"
+
+// Maximum number of galloping steps, covering a distance of up to 2^ASOF_GALLOP - 1 observations
+// -) a query time further away from the previous one is found by binary search over all observation times,
+//    whose first steps always visit the same positions and are therefore cached
+#define ASOF_GALLOP 8
+
+
+/******************* Helper functions ********************/
+
+// Last position i with times[i] <= x (or times[i] < x if 'strict'), or -1 if there is none
+// -) the search gallops from position 'hint' towards x with exponentially growing steps, and then bisects the
+//    bracket found, so that it takes O(log d) time for a distance d between 'hint' and the result; beyond
+//    ASOF_GALLOP steps it bisects all observation times instead
+static ptrdiff_t asof_search(double times[], ptrdiff_t n, double x, ptrdiff_t hint, int strict)
+{
+  // times  ... array of non-decreasing observation times
+  // n      ... number of observations, i.e. length of 'times'
+  // x      ... query time
+  // hint   ... guess of the result between -1 and n - 1, e.g. the result for the previous query time
+  // strict ... whether to search for the last observation time strictly before x
+  
+  ptrdiff_t lo, hi, mid, step = 1;
+  int steps = 0;
+  
+  if (hint < -1)
+    hint = -1;
+  if (hint > n - 1)
+    hint = n - 1;
+  
+  // Find a bracket with lo == -1 or times[lo] <= x, and hi == n or times[hi] > x (or >= x if 'strict')
+  if ((hint >= 0) && (strict ? (times[hint] >= x) : (times[hint] > x))) {
+    // Gallop to the left
+    hi = hint;
+    lo = hint - 1;
+    while ((lo >= 0) && (strict ? (times[lo] >= x) : (times[lo] > x))) {
+      hi = lo;
+      lo -= step;
+      step *= 2;
+      if (++steps == ASOF_GALLOP) {
+        lo = -1;
+        hi = n;
+      }
+    }
+    if (lo < -1)
+      lo = -1;
+  } else {
+    // Gallop to the right
+    lo = hint;
+    hi = hint + 1;
+    while ((hi < n) && (strict ? (times[hi] < x) : (times[hi] <= x))) {
+      lo = hi;
+      hi += step;
+      step *= 2;
+      if (++steps == ASOF_GALLOP) {
+        lo = -1;
+        hi = n;
+      }
+    }
+    if (hi > n)
+      hi = n;
+  }
+  
+  // Bisect the bracket
+  while (hi - lo > 1) {
+    mid = lo + (hi - lo) / 2;
+    if (strict ? (times[mid] < x) : (times[mid] <= x))
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Position of the observation used for query time x, or -1 if there is none, as described in asof_index
+static ptrdiff_t asof_position(double times[], ptrdiff_t n, double x, int type, double tolerance, ptrdiff_t *hint)
+{
+  // times     ... array of non-decreasing observation times
+  // n         ... number of observations, i.e. length of 'times'
+  // x         ... query time
+  // type      ... ASOF_LAST, ASOF_NEXT, or ASOF_LINEAR
+  // tolerance ... (non-negative) maximum distance between the query time and the observation times used
+  // hint      ... search hint, updated with the search result for the next query time
+  
+  ptrdiff_t pos;
+  
+  if (isnan(x))
+    return -1;
+  
+  if (type == ASOF_NEXT) {
+    // First observation at or after the query time
+    *hint = asof_search(times, n, x, *hint, 1);
+    pos = *hint + 1;
+    if ((pos >= n) || (times[pos] - x > tolerance))
+      return -1;
+    return pos;
+  }
+  
+  // Last observation at or before the query time
+  *hint = pos = asof_search(times, n, x, *hint, 0);
+  if ((pos < 0) || (x - times[pos] > tolerance))
+    return -1;
+  
+  // Linear interpolation also needs the next observation, unless the query time is an observation time
+  if ((type == ASOF_LINEAR) && (times[pos] < x) && ((pos == n - 1) || (times[pos + 1] - x > tolerance)))
+    return -1;
+  return pos;
+}
+
+/****************** END: Helper functions ****************/
+
+
+// Position of the observation used for each query time
+void asof_index(double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, ptrdiff_t index[], int *type, double *tolerance)
+{
+  // times      ... array of non-decreasing observation times
+  // n          ... number of observations, i.e. length of 'times'
+  // times_new  ... array of query times, which need not be sorted
+  // n_new      ... number of query times, i.e. length of 'times_new'
+  // index      ... array of length *n_new to store the positions of the observations, or -1 if there is none
+  // type       ... ASOF_LAST (last observation at or before the query time), ASOF_NEXT (first observation at or
+  //                after the query time), or ASOF_LINEAR (last observation at or before the query time, which
+  //                requires an observation after the query time as well, unless it is an observation time)
+  // tolerance  ... (non-negative) maximum distance between the query time and the observation times used
+  
+  ptrdiff_t hint = -1;
+  
+  for (ptrdiff_t j = 0; j < *n_new; j++)
+    index[j] = asof_position(times, *n, times_new[j], *type, *tolerance, &hint);
+}
+
+
+// Value of the time series at each query time
+void asof_sample(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[],
+  int *type, double *tolerance)
+{
+  // values     ... array of time series values
+  // times      ... array of non-decreasing observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // times_new  ... array of query times, which need not be sorted
+  // n_new      ... number of query times, i.e. length of 'times_new'
+  // values_new ... array of length *n_new to store the sampled values, or NaN if there is no suitable observation
+  // type       ... ASOF_LAST, ASOF_NEXT, or ASOF_LINEAR, see asof_index
+  // tolerance  ... (non-negative) maximum distance between the query time and the observation times used
+  
+  ptrdiff_t hint = -1, pos;
+  double x, w;
+  
+  for (ptrdiff_t j = 0; j < *n_new; j++) {
+    x = times_new[j];
+    pos = asof_position(times, *n, x, *type, *tolerance, &hint);
+    
+    if (pos < 0)
+      values_new[j] = NAN;
+    else if ((*type != ASOF_LINEAR) || (times[pos] == x))
+      values_new[j] = values[pos];
+    else {
+      // Linear interpolation between the observations before and after the query time
+      w = (x - times[pos]) / (times[pos + 1] - times[pos]);
+      values_new[j] = values[pos] * (1 - w) + values[pos + 1] * w;
+    }
+  }
+}
@@ -0,0 +1,26 @@
+// License: GPL-2 | GPL-3
+// Remark: To facilitate interfaces to other programming languages such as R, all variables are either pointers or arrays
+
+#ifndef _asof_h
+#define _asof_h
+
+#include <stddef.h>
+
+// Interpolation of observation values between observation times
+#define ASOF_LAST   0
+#define ASOF_NEXT   1
+#define ASOF_LINEAR 2
+
+/*
+As-of sampling of a time series at the times of another time index
+-) the position of each query time is found by galloping (exponential) search starting from the position of the
+   previous query time, followed by binary search, so that a query time d observations away from the previous one
+   takes O(log d) time, e.g. O(1) for sorted query times that are about as dense as the observation times, and
+   any other query time O(log n)
+-) a query time without a suitable observation, or whose observation is further away than the tolerance, gives
+   position -1 and value NaN
+*/
+void asof_index(double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, ptrdiff_t index[], int *type, double *tolerance);
+void asof_sample(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[], int *type, double *tolerance);
+
+#endif
@@ -0,0 +1,95 @@
+#include <Rcpp.h>
+#include <climits>
+#include <vector>
+
+extern "C" {
+#include "asof.h"
+}
+
+// Map the name of an interpolation type to ASOF_LAST, ASOF_NEXT or ASOF_LINEAR
+static int asof_type(const std::string& type) {
+  if (type == "last") return ASOF_LAST;
+  if (type == "next") return ASOF_NEXT;
+  if (type == "linear") return ASOF_LINEAR;
+  Rcpp::stop("Unknown interpolation type '" + type + "'.");
+  return ASOF_LAST;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here sample an irregularly spaced time series
+//' at the times of another time index, e.g. to align two series before
+//' calculating their co-moments, without merging them first.
+//'
+//' For \code{type = "last"} the value of the last observation at or
+//' before each time is used (i.e. the last observation is carried
+//' forward), for \code{type = "next"} that of the first observation at
+//' or after it, and for \code{type = "linear"} the linear interpolation
+//' of both. Observations further than \code{tolerance} away from the
+//' time are not used. Each time is located by galloping search starting
+//' from the location of the previous one, so that sorted times are found
+//' in a single pass, while unsorted times are supported as well. The
+//' inputs are used in place without copying.
+//' @title As-of sampling of irregularly spaced time series
+//' @param times A Datetime vector with non-decreasing observation times
+//' @param values A numeric vector
+//' @param at A Datetime vector with the sampling times
+//' @param type A character string, one of \code{"last"}, \code{"next"} or
+//' \code{"linear"}
+//' @param tolerance A double with the maximum time between a sampling
+//' time and the observations used for it
+//' @return For \code{asofSample}, a numeric vector with the sampled values,
+//' which are \code{NaN} if there is no suitable observation; for
+//' \code{asofIndex}, an integer vector with the (one-based) indices of the
+//' observations used, which are \code{NA} if there is none (a numeric vector
+//' for series too long for integer indices). For linear
+//' interpolation this is the observation at or before the sampling time.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{EMAat}}, \code{\link{rollingCov}}
+//' @examples
+//' times <- ISOdatetime(2010, 1, 2, 8, 30, 0) + c(0, 1.0, 1.2, 2.3, 2.9, 5.0)
+//' values <- seq(0, 10, by=2)
+//' grid <- times[1] + 0:6
+//' asofSample(times, values, grid)
+//' asofSample(times, values, grid, "linear")
+//' asofIndex(times, grid, "last", tolerance = 1)
+// [[Rcpp::export]]
+Rcpp::NumericVector asofSample(Rcpp::DatetimeVector times,
+                               Rcpp::NumericVector values,
+                               Rcpp::DatetimeVector at,
+                               const std::string type = "last",
+                               const double tolerance = R_PosInf) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (!(tolerance >= 0)) Rcpp::stop("Non-negative tolerance needed.");
+  R_xlen_t n = times.size(), m = at.size();
+  int t = asof_type(type);
+  Rcpp::NumericVector res(m);
+  asof_sample(values.begin(), times.begin(), &n, at.begin(), &m, res.begin(), &t,
+              const_cast<double*>(&tolerance));
+  return res;
+}
+
+//' @rdname asofSample
+// [[Rcpp::export]]
+SEXP asofIndex(Rcpp::DatetimeVector times,
+               Rcpp::DatetimeVector at,
+               const std::string type = "last",
+               const double tolerance = R_PosInf) {
+  if (!(tolerance >= 0)) Rcpp::stop("Non-negative tolerance needed.");
+  R_xlen_t n = times.size(), m = at.size();
+  int t = asof_type(type);
+  std::vector<ptrdiff_t> index(m);
+  asof_index(times.begin(), &n, at.begin(), &m, index.data(), &t, const_cast<double*>(&tolerance));
+  // Positions beyond the integer range are returned as doubles, like which()
+  if (n > INT_MAX) {
+    Rcpp::NumericVector res(m);
+    for (R_xlen_t j = 0; j < m; j++)
+      res[j] = (index[j] < 0) ? NA_REAL : (double) index[j] + 1;
+    return res;
+  }
+  Rcpp::IntegerVector res(m);
+  for (R_xlen_t j = 0; j < m; j++)
+    res[j] = (index[j] < 0) ? NA_INTEGER : (int) index[j] + 1;
+  return res;
+}
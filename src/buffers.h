@@ -0,0 +1,28 @@
+// Caller-supplied input and output vectors for the *Into functions
+// -) the vectors are used as given instead of being coerced by Rcpp, so that neither the inputs nor the output are
+//    copied; in particular the times are plain numeric vectors, without the POSIXct class set by DatetimeVector
+// -) the output vector is written in place, and returned without allocating a new R vector
+
+#ifndef _buffers_h
+#define _buffers_h
+
+#include <Rcpp.h>
+#include <string>
+
+// Wrap a double vector without coercion, which would silently copy it
+inline Rcpp::NumericVector double_buffer(SEXP x, const std::string& name) {
+  if (TYPEOF(x) != REALSXP) Rcpp::stop("Double vector needed for '" + name + "'.");
+  return Rcpp::NumericVector(x);
+}
+
+// Check that the output vector matches the inputs and does not share memory with them
+inline void check_buffers(Rcpp::NumericVector& times,
+                          Rcpp::NumericVector& values,
+                          Rcpp::NumericVector& out) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (out.size() != values.size()) Rcpp::stop("Matching output vector needed.");
+  if (out.size() > 0 && (out.begin() == times.begin() || out.begin() == values.begin()))
+    Rcpp::stop("Output vector must differ from the input vectors.");
+}
+
+#endif
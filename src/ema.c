@@ -1,12 +1,68 @@
 // Copyright: 2012-2017 by Andreas Eckner
 // License: GPL-2 | GPL-3
 
+#include <float.h>
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "ema.h"
 
+// SIMD versions of the EMA weight calculation, selected at run time by the *_fast functions
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define EMA_X86_DISPATCH
+#endif
+
+#ifndef MIN
+#  define MIN(a,b) (((a) < (b)) ? (a) : (b))
+#endif
+
+// Number of observations whose EMA weights are calculated together by the *_fast functions
+#define EMA_BLOCK 256
+
+
+// Same as ema_step, for the scaled time difference tmp = time_diff / tau and the weight w = exp(-tmp) of the
+// previous EMA value
+static inline double ema_step_weighted(double ema, double value_last, double value, double tmp, double w, int type)
+{
+  double w2;
+  
+  if (type == EMA_NEXT)
+    return ema * w + value * (1-w);
+  if (type == EMA_LAST)
+    return ema * w + value_last * (1-w);
+  if (tmp > 1e-6)
+    w2 = (1 - w) / tmp;
+  else {
+    // Use Taylor expansion for numerical stability
+    w2 = 1 - tmp/2 + tmp*tmp/6 - tmp*tmp*tmp/24;
+  }
+  return ema * w + value * (1 - w2) + value_last * (w2 - w);
+}
+
+
+// Update an EMA value with the next observation, using the same arithmetic as ema_next, ema_last and ema_linear
+double ema_step(double ema, double value_last, double value, double time_diff, double tau, int type)
+{
+  // ema        ... EMA value at the time of the previous observation
+  // value_last ... value of the previous observation
+  // value      ... value of the new observation
+  // time_diff  ... (non-negative) time between the previous and the new observation
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  double tmp = time_diff / tau;
+  
+  return ema_step_weighted(ema, value_last, value, tmp, exp(-tmp), type);
+}
+
 
 // EMA_next(X, tau)
-void ema_next(double values[], double times[], int *n, double values_new[], double *tau)
+void ema_next(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau)
 {
   // values     ... array of time series values
   // times      ... array of observation times
@@ -22,7 +78,7 @@ void ema_next(double values[], double times[], int *n, double values_new[], doub
   
   // Calculate ema recursively
   values_new[0] = values[0];
-  for (int i = 1; i < *n; i++) {
+  for (ptrdiff_t i = 1; i < *n; i++) {
     w = exp(-(times[i] - times[i-1]) / *tau);
     values_new[i] = values_new[i-1] * w + values[i] * (1-w);
   }
@@ -30,7 +86,7 @@ void ema_next(double values[], double times[], int *n, double values_new[], doub
 
 
 // EMA_last(X, tau)
-void ema_last(double values[], double times[], int *n, double values_new[], double *tau)
+void ema_last(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau)
 {
   // values     ... array of time series values
   // times      ... array of observation times
@@ -46,7 +102,7 @@ void ema_last(double values[], double times[], int *n, double values_new[], doub
   
   // Calculate ema recursively   
   values_new[0] = values[0];
-  for (int i = 1; i < *n; i++) {
+  for (ptrdiff_t i = 1; i < *n; i++) {
     w = exp(-(times[i] - times[i-1]) / *tau);
     values_new[i] = values_new[i-1] * w + values[i-1] * (1-w);
   }
@@ -55,7 +111,7 @@ void ema_last(double values[], double times[], int *n, double values_new[], doub
 
 
 // EMA_lin(X, tau)
-void ema_linear(double values[], double times[], int *n, double values_new[], double *tau)
+void ema_linear(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau)
 {
   // values     ... array of time series values
   // times      ... array of observation times
@@ -71,7 +127,7 @@ void ema_linear(double values[], double times[], int *n, double values_new[], do
   
   // Calculate ema recursively   
   values_new[0] = values[0];   
-  for (int i = 1; i < *n; i++) {
+  for (ptrdiff_t i = 1; i < *n; i++) {
     tmp = (times[i] - times[i-1]) / *tau;
     w = exp(-tmp);
     if (tmp > 1e-6)
@@ -83,3 +139,781 @@ void ema_linear(double values[], double times[], int *n, double values_new[], do
     values_new[i] = values_new[i-1] * w + values[i] * (1 - w2) + values[i-1] * (w2 - w);
   }
 }
+
+
+// EMA with 64-bit integer observation times, e.g. nanoseconds since the epoch
+// -) the time differences are calculated exactly in integer arithmetic, and only converted to double for the
+//    EMA weights; the arithmetic is otherwise that of ema_next, ema_last and ema_linear
+void ema_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], double *tau, int *type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel, in the unit of 'times'
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Calculate ema recursively
+  values_new[0] = values[0];
+  for (ptrdiff_t i = 1; i < *n; i++)
+    values_new[i] = ema_step(values_new[i-1], values[i-1], values[i], (double) (times[i] - times[i-1]), *tau, *type);
+}
+
+
+/*
+Multithreaded EMA using a parallel prefix scan
+-) the EMA recursion is an affine map of the previous EMA value, and the composition of the maps for the
+   observations of a chunk scales the value entering the chunk by exp(-(t_end - t_start) / tau)
+-) the series is split into one chunk per thread, each chunk is first processed with a zero starting value,
+   the true starting values are then propagated sequentially across chunks, and each chunk is corrected
+-) the first pass stores the decay of the value entering the chunk up to each observation, i.e. the running
+   product of the EMA weights, so that the correction is a multiply-add per observation without calling exp()
+-) the result matches the sequential algorithm up to rounding error
+*/
+static void ema_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau,
+  int type, int *num_threads)
+{
+  // values      ... array of time series values
+  // times       ... array of observation times
+  // n           ... number of observations, i.e. length of 'values' and 'times'
+  // values_new  ... array of length *n to store output time series values
+  // tau         ... (positive) half-life of EMA kernel
+  // type        ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  // num_threads ... number of threads
+  
+  int num_chunks;
+  ptrdiff_t chunk_size;
+  double *carry, *decay;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Split the series into chunks of equal size, one per available thread
+  num_chunks = (*num_threads < 1) ? 1 : *num_threads;
+#ifdef _OPENMP
+  if (num_chunks > omp_get_max_threads())
+    num_chunks = omp_get_max_threads();
+#endif
+  if (num_chunks > *n)
+    num_chunks = (int) *n;
+  chunk_size = (*n + num_chunks - 1) / num_chunks;
+  num_chunks = (int) ((*n + chunk_size - 1) / chunk_size);
+  carry = malloc(num_chunks * sizeof(double));
+  decay = malloc(*n * sizeof(double));   // not used for the first chunk
+  
+  // Calculate the EMA within each chunk, starting from zero (except for the first chunk)
+  #pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+  for (int k = 0; k < num_chunks; k++) {
+    ptrdiff_t start = k * chunk_size, end = (start + chunk_size < *n) ? start + chunk_size : *n;
+    double ema, tmp, w, d = 1;
+    
+    if (start == 0) {
+      values_new[0] = ema = values[0];
+      start = 1;
+    } else
+      ema = 0;
+    for (ptrdiff_t i = start; i < end; i++) {
+      tmp = (times[i] - times[i-1]) / *tau;
+      w = exp(-tmp);
+      ema = ema_step_weighted(ema, values[i-1], values[i], tmp, w, type);
+      values_new[i] = ema;
+      if (k > 0) {
+        // Flush the decay to zero once it underflows, as it would otherwise get stuck at the smallest
+        // subnormal number, which slows down every later multiplication
+        d = (d * w < DBL_MIN) ? 0 : d * w;
+        decay[i] = d;
+      }
+    }
+  }
+  
+  // Propagate the EMA value at the end of each chunk into the next chunk
+  carry[0] = 0;
+  for (int k = 1; k < num_chunks; k++) {
+    ptrdiff_t end = k * chunk_size;
+    if (k == 1)
+      carry[k] = values_new[end - 1];
+    else
+      carry[k] = values_new[end - 1] + carry[k-1] * decay[end - 1];
+  }
+  
+  // Add the decayed contribution of the value entering each chunk
+  #pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+  for (int k = 1; k < num_chunks; k++) {
+    ptrdiff_t start = k * chunk_size, end = (start + chunk_size < *n) ? start + chunk_size : *n;
+    
+    for (ptrdiff_t i = start; i < end; i++)
+      values_new[i] += carry[k] * decay[i];
+  }
+  free(carry);
+  free(decay);
+}
+
+
+// Multithreaded EMA_next(X, tau)
+void ema_next_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau,
+  int *num_threads)
+{
+  // values      ... array of time series values
+  // times       ... array of observation times
+  // n           ... number of observations, i.e. length of 'values' and 'times'
+  // values_new  ... array of length *n to store output time series values
+  // tau         ... (positive) half-life of EMA kernel
+  // num_threads ... number of threads
+  
+  ema_parallel(values, times, n, values_new, tau, EMA_NEXT, num_threads);
+}
+
+
+// Multithreaded EMA_last(X, tau)
+void ema_last_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau,
+  int *num_threads)
+{
+  // values      ... array of time series values
+  // times       ... array of observation times
+  // n           ... number of observations, i.e. length of 'values' and 'times'
+  // values_new  ... array of length *n to store output time series values
+  // tau         ... (positive) half-life of EMA kernel
+  // num_threads ... number of threads
+  
+  ema_parallel(values, times, n, values_new, tau, EMA_LAST, num_threads);
+}
+
+
+// Multithreaded EMA_lin(X, tau)
+void ema_linear_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau,
+  int *num_threads)
+{
+  // values      ... array of time series values
+  // times       ... array of observation times
+  // n           ... number of observations, i.e. length of 'values' and 'times'
+  // values_new  ... array of length *n to store output time series values
+  // tau         ... (positive) half-life of EMA kernel
+  // num_threads ... number of threads
+  
+  ema_parallel(values, times, n, values_new, tau, EMA_LINEAR, num_threads);
+}
+
+
+// EMA for several half-lives, see rolling_multi_kernel in rolling.h
+// -) each half-life takes the same steps as ema_next, ema_last or ema_linear, so the results equal theirs
+static void ema_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[],
+  ptrdiff_t *num_taus, int type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... column-major matrix with *n rows and *num_taus columns to store output values
+  // tau        ... array of (positive) half-lives of EMA kernel
+  // num_taus   ... number of half-lives, i.e. length of 'tau'
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  double *ema, time_diff;
+  
+  // Trivial case
+  if ((*n == 0) || (*num_taus == 0))
+    return;
+  
+  ema = malloc(*num_taus * sizeof(double));
+  for (ptrdiff_t k = 0; k < *num_taus; k++)
+    ema[k] = values_new[(size_t) k * *n] = values[0];
+  
+  // Calculate emas recursively
+  for (ptrdiff_t i = 1; i < *n; i++) {
+    time_diff = times[i] - times[i-1];
+    for (ptrdiff_t k = 0; k < *num_taus; k++) {
+      ema[k] = ema_step(ema[k], values[i-1], values[i], time_diff, tau[k], type);
+      values_new[(size_t) k * *n + i] = ema[k];
+    }
+  }
+  free(ema);
+}
+
+
+// EMA_next(X, tau) for several half-lives
+void ema_next_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[],
+  ptrdiff_t *num_taus)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... column-major matrix with *n rows and *num_taus columns to store output values
+  // tau        ... array of (positive) half-lives of EMA kernel
+  // num_taus   ... number of half-lives, i.e. length of 'tau'
+  
+  ema_multi(values, times, n, values_new, tau, num_taus, EMA_NEXT);
+}
+
+
+// EMA_last(X, tau) for several half-lives
+void ema_last_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[],
+  ptrdiff_t *num_taus)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... column-major matrix with *n rows and *num_taus columns to store output values
+  // tau        ... array of (positive) half-lives of EMA kernel
+  // num_taus   ... number of half-lives, i.e. length of 'tau'
+  
+  ema_multi(values, times, n, values_new, tau, num_taus, EMA_LAST);
+}
+
+
+// EMA_lin(X, tau) for several half-lives
+void ema_linear_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[],
+  ptrdiff_t *num_taus)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... column-major matrix with *n rows and *num_taus columns to store output values
+  // tau        ... array of (positive) half-lives of EMA kernel
+  // num_taus   ... number of half-lives, i.e. length of 'tau'
+  
+  ema_multi(values, times, n, values_new, tau, num_taus, EMA_LINEAR);
+}
+
+
+// Weights of the previous EMA value, the new observation value, and the previous observation value in the
+// EMA update, using the same arithmetic as ema_step
+static inline void ema_weights(double time_diff, double tau, int type, double *w, double *a, double *b)
+{
+  double w2, tmp = time_diff / tau;
+  
+  *w = exp(-tmp);
+  if (type == EMA_NEXT) {
+    *a = 1 - *w;
+    *b = 0;
+  } else if (type == EMA_LAST) {
+    *a = 0;
+    *b = 1 - *w;
+  } else {
+    if (tmp > 1e-6)
+      w2 = (1 - *w) / tmp;
+    else {
+      // Use Taylor expansion for numerical stability
+      w2 = 1 - tmp/2 + tmp*tmp/6 - tmp*tmp*tmp/24;
+    }
+    *a = 1 - w2;
+    *b = w2 - *w;
+  }
+}
+
+
+/*
+Exponentially weighted variance, i.e. EMA(X^2) - EMA(X)^2 with the weights of ema_next, ema_last, or ema_linear
+-) the EMA value and the central second moment are updated together, as a mixture of the previous weight
+   distribution with the new and the previous observation value, which avoids the cancellation of the
+   difference of the two EMAs
+*/
+static void ema_moments(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int type,
+  int sd)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  // sd         ... calculate the standard deviation (1) or the variance (0)
+  
+  double w, a, b, ema, ema_new, var;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Calculate ema and variance recursively
+  ema = values[0];
+  var = values_new[0] = 0;
+  for (ptrdiff_t i = 1; i < *n; i++) {
+    ema_weights(times[i] - times[i-1], *tau, type, &w, &a, &b);
+    ema_new = ema * w + values[i] * a + values[i-1] * b;
+    var = w * (var + (ema - ema_new) * (ema - ema_new)) + a * (values[i] - ema_new) * (values[i] - ema_new) +
+      b * (values[i-1] - ema_new) * (values[i-1] - ema_new);
+    ema = ema_new;
+    values_new[i] = sd ? sqrt(var) : var;
+  }
+}
+
+
+// Exponentially weighted variance
+void ema_var(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  ema_moments(values, times, n, values_new, tau, *type, 0);
+}
+
+
+// Exponentially weighted standard deviation
+void ema_sd(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  ema_moments(values, times, n, values_new, tau, *type, 1);
+}
+
+
+/*
+Exponentially weighted covariance or correlation of two time series with different observation times
+-) the observations of both time series are processed in the order of their observation times, where an
+   observation of each time series at the same time counts as a single update, and each update adds the pair of
+   most recent values of both time series to the weight distribution, like ema_moments does for a single series
+-) the recursion starts once both time series have an observation, and the output is the covariance or
+   correlation after each observation of the first time series (NaN before the start)
+*/
+static void ema_bivariate(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[],
+  ptrdiff_t *n_y, double values_new[], double *tau, int type, int cor)
+{
+  // values_x   ... array of values of first time series
+  // times_x    ... array of observation times of first time series
+  // n_x        ... number of observations of first time series
+  // values_y   ... array of values of second time series
+  // times_y    ... array of observation times of second time series
+  // n_y        ... number of observations of second time series
+  // values_new ... array of length *n_x to store output values at the observation times of the first series
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  // cor        ... calculate the correlation (1) or the covariance (0)
+  
+  ptrdiff_t i = 0, j = 0;
+  int started = 0, has_x, has_y;
+  double w, a, b, t, t_last = 0, x = 0, y = 0, x_last, y_last;
+  double ema_x = 0, ema_y = 0, ema_x_new, ema_y_new, var_x = 0, var_y = 0, cov = 0;
+  
+  while (i < *n_x) {
+    // Next observation time of either time series
+    t = ((j < *n_y) && (times_y[j] < times_x[i])) ? times_y[j] : times_x[i];
+    has_x = (times_x[i] == t);
+    has_y = (j < *n_y) && (times_y[j] == t);
+    x_last = x;
+    y_last = y;
+    if (has_x)
+      x = values_x[i];
+    if (has_y)
+      y = values_y[j];
+    
+    if (!started) {
+      // Start once both time series have an observation
+      if ((i + has_x > 0) && (j + has_y > 0)) {
+        started = 1;
+        ema_x = x;
+        ema_y = y;
+      }
+    } else {
+      // Update ema values and central second moments of the pairs of most recent values
+      ema_weights(t - t_last, *tau, type, &w, &a, &b);
+      ema_x_new = ema_x * w + x * a + x_last * b;
+      ema_y_new = ema_y * w + y * a + y_last * b;
+      cov = w * (cov + (ema_x - ema_x_new) * (ema_y - ema_y_new)) + a * (x - ema_x_new) * (y - ema_y_new) +
+        b * (x_last - ema_x_new) * (y_last - ema_y_new);
+      if (cor) {
+        var_x = w * (var_x + (ema_x - ema_x_new) * (ema_x - ema_x_new)) + a * (x - ema_x_new) * (x - ema_x_new) +
+          b * (x_last - ema_x_new) * (x_last - ema_x_new);
+        var_y = w * (var_y + (ema_y - ema_y_new) * (ema_y - ema_y_new)) + a * (y - ema_y_new) * (y - ema_y_new) +
+          b * (y_last - ema_y_new) * (y_last - ema_y_new);
+      }
+      ema_x = ema_x_new;
+      ema_y = ema_y_new;
+    }
+    t_last = t;
+    
+    // Save result at the observation times of the first time series
+    if (has_x) {
+      if (!started)
+        values_new[i] = NAN;
+      else
+        values_new[i] = cor ? cov / sqrt(var_x * var_y) : cov;
+      i++;
+    }
+    if (has_y)
+      j++;
+  }
+}
+
+
+// Exponentially weighted covariance of two time series
+void ema_cov(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y,
+  double values_new[], double *tau, int *type)
+{
+  // values_x   ... array of values of first time series
+  // times_x    ... array of observation times of first time series
+  // n_x        ... number of observations of first time series
+  // values_y   ... array of values of second time series
+  // times_y    ... array of observation times of second time series
+  // n_y        ... number of observations of second time series
+  // values_new ... array of length *n_x to store output values at the observation times of the first series
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  ema_bivariate(values_x, times_x, n_x, values_y, times_y, n_y, values_new, tau, *type, 0);
+}
+
+
+// Exponentially weighted correlation of two time series
+void ema_cor(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y,
+  double values_new[], double *tau, int *type)
+{
+  // values_x   ... array of values of first time series
+  // times_x    ... array of observation times of first time series
+  // n_x        ... number of observations of first time series
+  // values_y   ... array of values of second time series
+  // times_y    ... array of observation times of second time series
+  // n_y        ... number of observations of second time series
+  // values_new ... array of length *n_x to store output values at the observation times of the first series
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  ema_bivariate(values_x, times_x, n_x, values_y, times_y, n_y, values_new, tau, *type, 1);
+}
+
+
+/*
+EMA at arbitrary query times
+-) the EMA is a function of time, and its value at a query time t with t_k <= t < t_{k+1} is obtained from the EMA
+   at t_k by one more step of length t - t_k, using the value of the interpolated time series at t: X[t_k] for
+   EMA_LAST, X[t_{k+1}] for EMA_NEXT, and the linear interpolation of both for EMA_LINEAR
+-) at an observation time the result equals the corresponding output of ema_next, ema_last or ema_linear (of the
+   last observation for tied observation times), after the last observation the series is extended with its last
+   value, and before the first observation the result is NaN
+-) the query times are merged with the observation times, so that the run time is O(n + m)
+*/
+void ema_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[],
+  double *tau, int *type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // times_new  ... array of non-decreasing query times
+  // n_new      ... number of query times, i.e. length of 'times_new'
+  // values_new ... array of length *n_new to store the EMA at the query times
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  ptrdiff_t k = -1;
+  double ema = 0, value, w;
+  
+  for (ptrdiff_t j = 0; j < *n_new; j++) {
+    // Advance the EMA to the last observation at or before the query time
+    while ((k < *n - 1) && (times[k + 1] <= times_new[j])) {
+      if (k < 0)
+        ema = values[0];
+      else
+        ema = ema_step(ema, values[k], values[k + 1], times[k + 1] - times[k], *tau, *type);
+      k++;
+    }
+    
+    // No observation yet
+    if (k < 0) {
+      values_new[j] = NAN;
+      continue;
+    }
+    
+    // Value of the interpolated time series at the query time
+    if ((*type == EMA_LAST) || (k == *n - 1))
+      value = values[k];
+    else if (*type == EMA_NEXT)
+      value = values[k + 1];
+    else {
+      w = (times_new[j] - times[k]) / (times[k + 1] - times[k]);
+      value = values[k] * (1 - w) + values[k + 1] * w;
+    }
+    
+    values_new[j] = ema_step(ema, values[k], value, times_new[j] - times[k], *tau, *type);
+  }
+}
+
+
+// Same as ema_at, with 64-bit integer observation and query times, e.g. nanoseconds since the epoch
+// -) the time differences are calculated exactly in integer arithmetic, as in ema_int64
+void ema_at_int64(double values[], int64_t times[], ptrdiff_t *n, int64_t times_new[], ptrdiff_t *n_new,
+  double values_new[], double *tau, int *type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // times_new  ... array of non-decreasing query times
+  // n_new      ... number of query times, i.e. length of 'times_new'
+  // values_new ... array of length *n_new to store the EMA at the query times
+  // tau        ... (positive) half-life of EMA kernel, in the unit of 'times'
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  ptrdiff_t k = -1;
+  double ema = 0, value, w;
+  
+  for (ptrdiff_t j = 0; j < *n_new; j++) {
+    // Advance the EMA to the last observation at or before the query time
+    while ((k < *n - 1) && (times[k + 1] <= times_new[j])) {
+      if (k < 0)
+        ema = values[0];
+      else
+        ema = ema_step(ema, values[k], values[k + 1], (double) (times[k + 1] - times[k]), *tau, *type);
+      k++;
+    }
+    
+    // No observation yet
+    if (k < 0) {
+      values_new[j] = NAN;
+      continue;
+    }
+    
+    // Value of the interpolated time series at the query time
+    if ((*type == EMA_LAST) || (k == *n - 1))
+      value = values[k];
+    else if (*type == EMA_NEXT)
+      value = values[k + 1];
+    else {
+      w = (double) (times_new[j] - times[k]) / (double) (times[k + 1] - times[k]);
+      value = values[k] * (1 - w) + values[k + 1] * w;
+    }
+    
+    values_new[j] = ema_step(ema, values[k], value, (double) (times_new[j] - times[k]), *tau, *type);
+  }
+}
+
+/****************** BEGIN: Fast EMA weights ****************/
+
+/*
+Polynomial approximation of exp(x) for x <= 0, used to calculate EMA weights in batches
+-) Cody-Waite range reduction x = k*log(2) + r with |r| <= log(2)/2, Taylor polynomial of degree 13 for exp(r),
+   and scaling by 2^k via the exponent bits
+-) the result is within 1.2 ulp of exp(x) for x in [-708, 0] (the measured maximum over 2e7 random arguments
+   is 1.15 ulp); arguments below -708 give 0, i.e. weights below 3.3e-308 are flushed to zero
+-) the scalar, AVX2 and AVX-512 versions use the same operations, but the compiler may contract
+   multiplications and additions of the AVX-512 version into fused multiply-adds, so the weights can differ
+   in the last bit between CPUs
+*/
+#define EXP_LOG2E   1.4426950408889634
+#define EXP_LN2_HI  6.93147180369123816490e-01
+#define EXP_LN2_LO  1.90821492927058770002e-10
+#define EXP_SHIFTER 6755399441055744.0   // 1.5 * 2^52, rounds to the nearest integer when added
+#define EXP_MIN     -708.0
+
+static const double exp_coef[14] = {1.0/6227020800.0, 1.0/479001600.0, 1.0/39916800.0, 1.0/3628800.0,
+  1.0/362880.0, 1.0/40320.0, 1.0/5040.0, 1.0/720.0, 1.0/120.0, 1.0/24.0, 1.0/6.0, 0.5, 1.0, 1.0};
+
+
+static inline double exp_poly(double x)
+{
+  double kd, r, p, scale;
+  uint64_t bits;
+  
+  if (x < EXP_MIN)
+    return 0;
+  
+  // Range reduction
+  kd = x * EXP_LOG2E + EXP_SHIFTER;
+  memcpy(&bits, &kd, sizeof(double));
+  kd = kd - EXP_SHIFTER;
+  r = (x - kd * EXP_LN2_HI) - kd * EXP_LN2_LO;
+  
+  // Polynomial approximation and scaling by 2^k
+  p = exp_coef[0];
+  for (int j = 1; j < 14; j++)
+    p = p * r + exp_coef[j];
+  bits = (bits + 1023) << 52;
+  memcpy(&scale, &bits, sizeof(double));
+  return p * scale;
+}
+
+
+// Scaled time differences and EMA weights of m consecutive observations
+typedef void (*ema_weights_fn)(double times[], int m, double inv_tau, double tmp[], double w[]);
+
+static void ema_weights_scalar(double times[], int m, double inv_tau, double tmp[], double w[])
+{
+  // times   ... array of m + 1 observation times
+  // m       ... number of weights
+  // inv_tau ... reciprocal of the half-life of EMA kernel
+  // tmp     ... array of length m to store (times[j+1] - times[j]) / tau
+  // w       ... array of length m to store exp(-tmp[j])
+  
+  for (int j = 0; j < m; j++) {
+    tmp[j] = (times[j+1] - times[j]) * inv_tau;
+    w[j] = exp_poly(-tmp[j]);
+  }
+}
+
+
+#ifdef EMA_X86_DISPATCH
+__attribute__((target("avx2")))
+static void ema_weights_avx2(double times[], int m, double inv_tau, double tmp[], double w[])
+{
+  const __m256d log2e = _mm256_set1_pd(EXP_LOG2E), shifter = _mm256_set1_pd(EXP_SHIFTER);
+  const __m256d ln2_hi = _mm256_set1_pd(EXP_LN2_HI), ln2_lo = _mm256_set1_pd(EXP_LN2_LO);
+  const __m256d min_x = _mm256_set1_pd(EXP_MIN), neg = _mm256_set1_pd(-0.0), scale = _mm256_set1_pd(inv_tau);
+  const __m256i bias = _mm256_set1_epi64x(1023);
+  int j = 0;
+  
+  for (; j + 4 <= m; j += 4) {
+    __m256d d = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(times + j + 1), _mm256_loadu_pd(times + j)), scale);
+    __m256d x = _mm256_xor_pd(d, neg);
+    __m256d kd = _mm256_add_pd(_mm256_mul_pd(x, log2e), shifter);
+    __m256i bits = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(kd), bias), 52);
+    kd = _mm256_sub_pd(kd, shifter);
+    __m256d r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(kd, ln2_hi)), _mm256_mul_pd(kd, ln2_lo));
+    __m256d p = _mm256_set1_pd(exp_coef[0]);
+    for (int k = 1; k < 14; k++)
+      p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(exp_coef[k]));
+    p = _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+    p = _mm256_andnot_pd(_mm256_cmp_pd(x, min_x, _CMP_LT_OQ), p);
+    _mm256_storeu_pd(tmp + j, d);
+    _mm256_storeu_pd(w + j, p);
+  }
+  
+  // Avoid the penalty of SSE instructions in the remainder and the caller after dirtying the upper registers
+  _mm256_zeroupper();
+  ema_weights_scalar(times + j, m - j, inv_tau, tmp + j, w + j);
+}
+
+
+__attribute__((target("avx512f")))
+static void ema_weights_avx512(double times[], int m, double inv_tau, double tmp[], double w[])
+{
+  const __m512d log2e = _mm512_set1_pd(EXP_LOG2E), shifter = _mm512_set1_pd(EXP_SHIFTER);
+  const __m512d ln2_hi = _mm512_set1_pd(EXP_LN2_HI), ln2_lo = _mm512_set1_pd(EXP_LN2_LO);
+  const __m512d min_x = _mm512_set1_pd(EXP_MIN), scale = _mm512_set1_pd(inv_tau);
+  const __m512i bias = _mm512_set1_epi64(1023);
+  int j = 0;
+  
+  for (; j + 8 <= m; j += 8) {
+    __m512d d = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(times + j + 1), _mm512_loadu_pd(times + j)), scale);
+    __m512d x = _mm512_sub_pd(_mm512_setzero_pd(), d);
+    __m512d kd = _mm512_add_pd(_mm512_mul_pd(x, log2e), shifter);
+    __m512i bits = _mm512_slli_epi64(_mm512_add_epi64(_mm512_castpd_si512(kd), bias), 52);
+    kd = _mm512_sub_pd(kd, shifter);
+    __m512d r = _mm512_sub_pd(_mm512_sub_pd(x, _mm512_mul_pd(kd, ln2_hi)), _mm512_mul_pd(kd, ln2_lo));
+    __m512d p = _mm512_set1_pd(exp_coef[0]);
+    for (int k = 1; k < 14; k++)
+      p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(exp_coef[k]));
+    p = _mm512_mul_pd(p, _mm512_castsi512_pd(bits));
+    p = _mm512_mask_mov_pd(p, _mm512_cmp_pd_mask(x, min_x, _CMP_LT_OQ), _mm512_setzero_pd());
+    _mm512_storeu_pd(tmp + j, d);
+    _mm512_storeu_pd(w + j, p);
+  }
+  
+  _mm256_zeroupper();
+  ema_weights_scalar(times + j, m - j, inv_tau, tmp + j, w + j);
+}
+#endif
+
+
+// Select the fastest version of the EMA weight calculation supported by the CPU
+static ema_weights_fn ema_weights_select(void)
+{
+#ifdef EMA_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return ema_weights_avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return ema_weights_avx2;
+#endif
+  return ema_weights_scalar;
+}
+
+/****************** END: Fast EMA weights ****************/
+
+
+/*
+EMA with the weights of a block of observations calculated up front
+-) the weights only depend on the observation times, so they are calculated in a vectorized pass using the
+   polynomial exp above and the reciprocal of tau, and the recursion then only needs multiplications and additions
+-) the results differ from ema_next, ema_last and ema_linear by the error of the weights (see exp_poly) and of
+   multiplying by the reciprocal of tau instead of dividing by tau
+*/
+static void ema_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int type)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  // type       ... EMA_NEXT, EMA_LAST, or EMA_LINEAR
+  
+  double w[EMA_BLOCK], tmp[EMA_BLOCK], w2, ema;
+  ema_weights_fn weights = ema_weights_select();
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Calculate ema recursively, one block of weights at a time
+  ema = values_new[0] = values[0];
+  for (ptrdiff_t start = 1; start < *n; start += EMA_BLOCK) {
+    int m = (int) MIN(EMA_BLOCK, *n - start);
+    weights(times + start - 1, m, 1 / *tau, tmp, w);
+    
+    if (type == EMA_NEXT) {
+      for (int j = 0; j < m; j++)
+        values_new[start + j] = ema = ema * w[j] + values[start + j] * (1 - w[j]);
+    } else if (type == EMA_LAST) {
+      for (int j = 0; j < m; j++)
+        values_new[start + j] = ema = ema * w[j] + values[start + j - 1] * (1 - w[j]);
+    } else {
+      for (int j = 0; j < m; j++) {
+        if (tmp[j] > 1e-6)
+          w2 = (1 - w[j]) / tmp[j];
+        else {
+          // Use Taylor expansion for numerical stability
+          w2 = 1 - tmp[j]/2 + tmp[j]*tmp[j]/6 - tmp[j]*tmp[j]*tmp[j]/24;
+        }
+        values_new[start + j] = ema = ema * w[j] + values[start + j] * (1 - w2) + values[start + j - 1] * (w2 - w[j]);
+      }
+    }
+  }
+}
+
+
+// EMA_next(X, tau) with vectorized weight calculation
+void ema_next_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  
+  ema_fast(values, times, n, values_new, tau, EMA_NEXT);
+}
+
+
+// EMA_last(X, tau) with vectorized weight calculation
+void ema_last_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  
+  ema_fast(values, times, n, values_new, tau, EMA_LAST);
+}
+
+
+// EMA_lin(X, tau) with vectorized weight calculation
+void ema_linear_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau)
+{
+  // values     ... array of time series values
+  // times      ... array of observation times
+  // n          ... number of observations, i.e. length of 'values' and 'times'
+  // values_new ... array of length *n to store output time series values
+  // tau        ... (positive) half-life of EMA kernel
+  
+  ema_fast(values, times, n, values_new, tau, EMA_LINEAR);
+}
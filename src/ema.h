@@ -5,8 +5,39 @@
 #ifndef _ema_h
 #define _ema_h
 
-void ema_next(double values[], double times[], int *n, double values_new[], double *tau);
-void ema_last(double values[], double times[], int *n, double values_new[], double *tau);
-void ema_linear(double values[], double times[], int *n, double values_new[], double *tau);
+#include <stddef.h>
+#include <stdint.h>
+
+// Interpolation of observation values between observation times
+#define EMA_NEXT   0
+#define EMA_LAST   1
+#define EMA_LINEAR 2
+
+void ema_next(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
+void ema_last(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
+void ema_linear(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
+
+double ema_step(double ema, double value_last, double value, double time_diff, double tau, int type);
+void ema_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], double *tau, int *type);
+
+void ema_next_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *num_threads);
+void ema_last_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *num_threads);
+void ema_linear_parallel(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *num_threads);
+
+void ema_next_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[], ptrdiff_t *num_taus);
+void ema_last_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[], ptrdiff_t *num_taus);
+void ema_linear_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[], ptrdiff_t *num_taus);
+
+void ema_var(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *type);
+void ema_sd(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau, int *type);
+void ema_cov(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y, double values_new[], double *tau, int *type);
+void ema_cor(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y, double values_new[], double *tau, int *type);
+
+void ema_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[], double *tau, int *type);
+void ema_at_int64(double values[], int64_t times[], ptrdiff_t *n, int64_t times_new[], ptrdiff_t *n_new, double values_new[], double *tau, int *type);
+
+void ema_next_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
+void ema_last_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
+void ema_linear_fast(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
 
 #endif
@@ -1,9 +1,70 @@
 #include <Rcpp.h>
+#include <algorithm>
+#include <climits>
 
 extern "C" {
 #include "ema.h"
 }
 
+#include "buffers.h"
+#include "int64_times.h"
+
+// EMA kernels, and their multithreaded versions
+typedef void (*ema_kernel)(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau);
+typedef void (*ema_parallel_kernel)(double values[], double times[], ptrdiff_t *n, double values_new[], double *tau,
+                                    int *num_threads);
+typedef void (*ema_multi_kernel)(double values[], double times[], ptrdiff_t *n, double values_new[], double tau[],
+                                 ptrdiff_t *num_taus);
+
+// Map the name of an EMA type to EMA_NEXT, EMA_LAST or EMA_LINEAR
+static int ema_type(const std::string& type) {
+  if (type == "next") return EMA_NEXT;
+  if (type == "last") return EMA_LAST;
+  if (type == "linear") return EMA_LINEAR;
+  Rcpp::stop("Unknown EMA type '" + type + "'.");
+  return EMA_NEXT;
+}
+
+// Apply an EMA kernel, or ema_int64 for integer observation times, for which 'threads' and 'fast' are ignored
+static Rcpp::NumericVector ema_apply(ema_kernel kernel,
+                                     ema_kernel fast_kernel,
+                                     ema_parallel_kernel parallel_kernel,
+                                     int type,
+                                     SEXP times,
+                                     Rcpp::NumericVector values,
+                                     TimeWidth tau,
+                                     int threads,
+                                     bool fast) {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  R_xlen_t n = values.size();
+  Rcpp::NumericVector res(n);
+  if (is_int64_times(times))
+    ema_int64(values.begin(), int64_times(times), &n, res.begin(), tau.ptr(), &type);
+  else {
+    Rcpp::DatetimeVector t(times);
+    if (threads > 1)
+      parallel_kernel(values.begin(), t.begin(), &n, res.begin(), tau.ptr(), &threads);
+    else if (fast)
+      fast_kernel(values.begin(), t.begin(), &n, res.begin(), tau.ptr());
+    else
+      kernel(values.begin(), t.begin(), &n, res.begin(), tau.ptr());
+  }
+  return res;
+}
+
+// Apply an EMA kernel for several half-lives
+static Rcpp::NumericMatrix ema_apply_multi(ema_multi_kernel kernel,
+                                           Rcpp::DatetimeVector times,
+                                           Rcpp::NumericVector values,
+                                           Rcpp::NumericVector tau) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  R_xlen_t n = times.size(), k = tau.size();
+  if (k > INT_MAX) Rcpp::stop("Too many half-lives for the columns of a matrix.");
+  Rcpp::NumericMatrix res(n, (int) k);
+  kernel(values.begin(), times.begin(), &n, res.begin(), tau.begin(), &k);
+  return res;
+}
+
 //' The UTS library by Andreas Eckner provides algorithms for unevenly
 //' spaced time-series data.  This package brings a few of them to R.
 //' The functions describe here offer exponentially-decaying weighted moving
@@ -11,9 +72,24 @@ extern "C" {
 //' the last or next observation relative to time \sQuote{t}, as well as
 //' linear interpolation between them.
 //' @title EMA functions for unevenly spaced time series
-//' @param times A Datetime vector
+//' @param times A Datetime vector, or a nanotime or integer64 vector with
+//' integer times, e.g. nanoseconds, whose differences are then calculated
+//' exactly in integer arithmetic
 //' @param values A numeric vector
-//' @param tau A double with the decay factor
+//' @param tau A double, or an integer64 value such as a nanoduration, with
+//' the decay factor, in the unit of the times (i.e. nanoseconds for
+//' nanotime)
+//' @param threads An integer with the number of threads; values above one
+//' select a parallel prefix-scan algorithm which agrees with the sequential
+//' one up to rounding error. It is ignored for integer times.
+//' @param fast A boolean selecting a faster single-threaded algorithm, which
+//' computes the EMA weights in batches using a vectorized polynomial
+//' approximation of the exponential function (with AVX2 or AVX-512 where
+//' supported by the CPU). The weights are within 1.2 ulp of the exact
+//' values, which are flushed to zero below \code{exp(-708)}; the
+//' \code{EMAlinear} results are more sensitive to this error for time
+//' differences much smaller than \code{tau}. It is ignored for more than
+//' one thread or integer times.
 //' @return A numeric vector with EMA-weighted values.
 //' package at the given position is available.
 //' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
@@ -37,36 +113,270 @@ extern "C" {
 //'               col=c("black", "lightblue", "darkblue", "mediumblue"))
 //' }
 // [[Rcpp::export]]
-Rcpp::NumericVector EMAnext(Rcpp::DatetimeVector times,
+Rcpp::NumericVector EMAnext(SEXP times,
                             Rcpp::NumericVector values,
-                            const double tau) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  ema_next(values.begin(), times.begin(), &n, res.begin(), const_cast<double*>(&tau));
-  return res;
+                            const TimeWidth tau,
+                            int threads = 1,
+                            bool fast = false) {
+  return ema_apply(ema_next, ema_next_fast, ema_next_parallel, EMA_NEXT, times, values, tau, threads, fast);
 }
 
 //' @rdname EMAnext
 // [[Rcpp::export]]
-Rcpp::NumericVector EMAlast(Rcpp::DatetimeVector times,
+Rcpp::NumericVector EMAlast(SEXP times,
                             Rcpp::NumericVector values,
-                            const double tau) {
+                            const TimeWidth tau,
+                            int threads = 1,
+                            bool fast = false) {
+  return ema_apply(ema_last, ema_last_fast, ema_last_parallel, EMA_LAST, times, values, tau, threads, fast);
+}
+
+//' @rdname EMAnext
+// [[Rcpp::export]]
+Rcpp::NumericVector EMAlinear(SEXP times,
+                              Rcpp::NumericVector values,
+                              const TimeWidth tau,
+                              int threads = 1,
+                              bool fast = false) {
+  return ema_apply(ema_linear, ema_linear_fast, ema_linear_parallel, EMA_LINEAR, times, values, tau, threads, fast);
+}
+
+//' @rdname rollingMeanMulti
+//' @param tau A numeric vector with the decay factors
+// [[Rcpp::export]]
+Rcpp::NumericMatrix EMAnextMulti(Rcpp::DatetimeVector times,
+                                 Rcpp::NumericVector values,
+                                 Rcpp::NumericVector tau) {
+  return ema_apply_multi(ema_next_multi, times, values, tau);
+}
+
+//' @rdname rollingMeanMulti
+// [[Rcpp::export]]
+Rcpp::NumericMatrix EMAlastMulti(Rcpp::DatetimeVector times,
+                                 Rcpp::NumericVector values,
+                                 Rcpp::NumericVector tau) {
+  return ema_apply_multi(ema_last_multi, times, values, tau);
+}
+
+//' @rdname rollingMeanMulti
+// [[Rcpp::export]]
+Rcpp::NumericMatrix EMAlinearMulti(Rcpp::DatetimeVector times,
+                                   Rcpp::NumericVector values,
+                                   Rcpp::NumericVector tau) {
+  return ema_apply_multi(ema_linear_multi, times, values, tau);
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here offer exponentially weighted variance,
+//' standard deviation, covariance and correlation, using the weights of
+//' \code{\link{EMAnext}}, \code{\link{EMAlast}} or
+//' \code{\link{EMAlinear}}. The variance equals \code{EMA(X^2) - EMA(X)^2}
+//' but is calculated in a single pass without the cancellation of that
+//' difference.
+//'
+//' For two time series, the observations of both are processed in the
+//' order of their observation times, with each update adding the pair of
+//' most recent values of both series; observations of both series at the
+//' same time count as a single update. The results are given at the
+//' observation times of the first series, and are \code{NA} before both
+//' series have an observation.
+//' @title Exponentially weighted moments for unevenly spaced time series
+//' @param times A Datetime vector
+//' @param values A numeric vector
+//' @param tau A double with the decay factor
+//' @param type A character string with the EMA type, one of \code{"next"},
+//' \code{"last"} or \code{"linear"}
+//' @return A numeric vector with the exponentially weighted moment.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{EMAnext}}
+// [[Rcpp::export]]
+Rcpp::NumericVector EMAvar(Rcpp::DatetimeVector times,
+                           Rcpp::NumericVector values,
+                           const TimeWidth tau,
+                           const std::string type = "next") {
   if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
+  R_xlen_t n = times.size();
+  int t = ema_type(type);
   Rcpp::NumericVector res(n);
-  ema_last(values.begin(), times.begin(), &n, res.begin(), const_cast<double*>(&tau));
+  ema_var(values.begin(), times.begin(), &n, res.begin(), tau.ptr(), &t);
   return res;
 }
 
-//' @rdname EMAnext
+//' @rdname EMAvar
 // [[Rcpp::export]]
-Rcpp::NumericVector EMAlinear(Rcpp::DatetimeVector times,
-                              Rcpp::NumericVector values,
-                              const double tau) {
+Rcpp::NumericVector EMAsd(Rcpp::DatetimeVector times,
+                          Rcpp::NumericVector values,
+                          const TimeWidth tau,
+                          const std::string type = "next") {
   if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
+  R_xlen_t n = times.size();
+  int t = ema_type(type);
   Rcpp::NumericVector res(n);
-  ema_linear(values.begin(), times.begin(), &n, res.begin(), const_cast<double*>(&tau));
+  ema_sd(values.begin(), times.begin(), &n, res.begin(), tau.ptr(), &t);
+  return res;
+}
+
+//' @rdname EMAvar
+//' @param timesx A Datetime vector with the observation times of the first series
+//' @param valuesx A numeric vector with the values of the first series
+//' @param timesy A Datetime vector with the observation times of the second series
+//' @param valuesy A numeric vector with the values of the second series
+// [[Rcpp::export]]
+Rcpp::NumericVector EMAcov(Rcpp::DatetimeVector timesx,
+                           Rcpp::NumericVector valuesx,
+                           Rcpp::DatetimeVector timesy,
+                           Rcpp::NumericVector valuesy,
+                           const TimeWidth tau,
+                           const std::string type = "next") {
+  if (timesx.size() != valuesx.size() || timesy.size() != valuesy.size())
+    Rcpp::stop("Matching vectors needed.");
+  R_xlen_t nx = timesx.size(), ny = timesy.size();
+  int t = ema_type(type);
+  Rcpp::NumericVector res(nx);
+  ema_cov(valuesx.begin(), timesx.begin(), &nx, valuesy.begin(), timesy.begin(), &ny, res.begin(),
+          tau.ptr(), &t);
   return res;
 }
+
+//' @rdname EMAvar
+// [[Rcpp::export]]
+Rcpp::NumericVector EMAcor(Rcpp::DatetimeVector timesx,
+                           Rcpp::NumericVector valuesx,
+                           Rcpp::DatetimeVector timesy,
+                           Rcpp::NumericVector valuesy,
+                           const TimeWidth tau,
+                           const std::string type = "next") {
+  if (timesx.size() != valuesx.size() || timesy.size() != valuesy.size())
+    Rcpp::stop("Matching vectors needed.");
+  R_xlen_t nx = timesx.size(), ny = timesy.size();
+  int t = ema_type(type);
+  Rcpp::NumericVector res(nx);
+  ema_cor(valuesx.begin(), timesx.begin(), &nx, valuesy.begin(), timesy.begin(), &ny, res.begin(),
+          tau.ptr(), &t);
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here evaluate the EMA and SMA at arbitrary
+//' output times instead of the observation times, e.g. on a regular time
+//' grid or at the observation times of another series.
+//'
+//' The value at an output time uses the time series interpolated as
+//' given by \code{type}, i.e. the last or next observation relative to
+//' the output time, or linear interpolation between them, consistently
+//' with \code{\link{EMAlast}}, \code{\link{EMAnext}} and
+//' \code{\link{EMAlinear}} (and the corresponding SMA functions). At an
+//' observation time the result equals that of the corresponding function,
+//' except for the first observation time of an SMA, and for
+//' \code{SMAnext} with a positive \code{widthafter}, where the window
+//' after the last observation in it uses the value of the next
+//' observation. After the last observation the series is extended with
+//' its last value, and before the first observation the result is
+//' \code{NaN}. The output times are merged with the observation times in
+//' a single pass.
+//' @title EMA and SMA at arbitrary output times
+//' @param times A Datetime vector, or for \code{EMAat} also a nanotime or
+//' integer64 vector with integer times, e.g. nanoseconds, whose
+//' differences are then taken exactly in integer arithmetic
+//' @param values A numeric vector
+//' @param at A vector with non-decreasing output times, of the same class
+//' as \code{times}
+//' @param tau A double with the decay factor, in the unit of the times
+//' @param type A character string, one of \code{"next"}, \code{"last"} or
+//' \code{"linear"}
+//' @return A numeric vector with the EMA or SMA at the output times.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingSummaryAt}}
+//' @examples
+//' times <- ISOdatetime(2010, 1, 2, 8, 30, 0) + c(0, 1.0, 1.2, 2.3, 2.9, 5.0)
+//' values <- seq(0, 10, by=2)
+//' grid <- times[1] + 0:6
+//' EMAat(times, values, grid, 1.5, "last")
+//' SMAat(times, values, grid, 2, 0, "linear")
+// [[Rcpp::export]]
+Rcpp::NumericVector EMAat(SEXP times,
+                          Rcpp::NumericVector values,
+                          SEXP at,
+                          const TimeWidth tau,
+                          const std::string type = "next") {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (is_int64_times(times) != is_int64_times(at)) Rcpp::stop("Matching time classes needed.");
+  R_xlen_t n = values.size(), m = XLENGTH(at);
+  int t = ema_type(type);
+  Rcpp::NumericVector res(m);
+  if (is_int64_times(times)) {
+    int64_t *a = int64_times(at);
+    if (!std::is_sorted(a, a + m)) Rcpp::stop("Non-decreasing output times needed.");
+    ema_at_int64(values.begin(), int64_times(times), &n, a, &m, res.begin(), tau.ptr(), &t);
+    return res;
+  }
+  Rcpp::DatetimeVector ti(times), a(at);
+  if (!std::is_sorted(a.begin(), a.end())) Rcpp::stop("Non-decreasing output times needed.");
+  ema_at(values.begin(), ti.begin(), &n, a.begin(), &m, res.begin(), tau.ptr(), &t);
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here compute the EMA, SMA and rolling
+//' operations into an existing output vector, for repeated use in loops
+//' where allocating a new result on each call dominates the run time.
+//'
+//' The output vector \code{out} is overwritten in place and returned, so
+//' that no new vector is allocated; like other functions modifying their
+//' arguments it also changes all R variables referring to the same
+//' vector. It can be a column of a data frame or matrix column, but must
+//' differ from \code{times} and \code{values}. The inputs are used as
+//' given instead of being coerced, so that they are never copied: all
+//' three vectors must be double vectors (\code{times} can be a POSIXct
+//' vector or a plain numeric vector) of the same length, and integer
+//' vectors are an error instead of being converted. The computational
+//' kernels for the maximum, minimum, median and (log) product still use
+//' temporary memory outside of R.
+//' @title EMA, SMA and rolling operations into an existing output vector
+//' @param times A double vector with the observation times
+//' @param values A double vector
+//' @param out A double vector of the same length, which is overwritten
+//' with the result
+//' @param tau A double with the decay factor
+//' @param type A character string, one of \code{"next"}, \code{"last"} or
+//' \code{"linear"}
+//' @param fast A boolean selecting the faster EMA algorithm, see
+//' \code{\link{EMAnext}}
+//' @return The vector \code{out}.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @examples
+//' times <- as.numeric(ISOdatetime(2010, 1, 2, 8, 30, 0)) + c(0, 1.0, 1.2, 2.3, 2.9, 5.0)
+//' values <- seq(0, 10, by=2)
+//' out <- numeric(length(values))
+//' for (tau in 1:3) EMAinto(times, values, out, tau, "last")
+//' SMAinto(times, values, out, 2, 0, "linear")
+//' rollingInto(times, values, out, 2, 0, "max")
+// [[Rcpp::export]]
+SEXP EMAinto(SEXP times,
+             SEXP values,
+             SEXP out,
+             const TimeWidth tau,
+             const std::string type = "next",
+             bool fast = false) {
+  Rcpp::NumericVector t = double_buffer(times, "times"), v = double_buffer(values, "values"),
+    res = double_buffer(out, "out");
+  check_buffers(t, v, res);
+  R_xlen_t n = t.size();
+  switch (ema_type(type)) {
+  case EMA_NEXT:
+    (fast ? ema_next_fast : ema_next)(v.begin(), t.begin(), &n, res.begin(), tau.ptr());
+    break;
+  case EMA_LAST:
+    (fast ? ema_last_fast : ema_last)(v.begin(), t.begin(), &n, res.begin(), tau.ptr());
+    break;
+  default:
+    (fast ? ema_linear_fast : ema_linear)(v.begin(), t.begin(), &n, res.begin(), tau.ptr());
+  }
+  return out;
+}
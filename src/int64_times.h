@@ -0,0 +1,78 @@
+// Integer observation times, as stored by the bit64 and nanotime packages
+// -) an integer64 vector is a double vector with class "integer64" whose elements hold the bits of 64-bit
+//    integers, e.g. nanoseconds since the epoch for nanotime
+// -) nanotime and nanoduration vectors are S4 objects extending integer64, whose class attribute names the S4
+//    class only, while "integer64" is recorded in their ".S3Class" attribute
+// -) NA_integer64 is stored as INT64_MIN, and is rejected instead of entering the window arithmetic
+// -) such times are passed to the kernels as int64_t, so that the rolling windows use exact integer arithmetic;
+//    window widths and decay factors are in the same unit as the times, i.e. nanoseconds for nanotime, and
+//    may themselves be integer64 scalars, e.g. nanoduration
+
+#ifndef _int64_times_h
+#define _int64_times_h
+
+#include <Rcpp.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Whether a vector of observation times holds 64-bit integers, i.e. is an integer64 vector or an S4 object
+// extending integer64
+inline bool is_int64_times(SEXP times) {
+  if (TYPEOF(times) != REALSXP) return false;
+  if (Rf_inherits(times, "integer64")) return true;
+  if (!IS_S4_OBJECT(times)) return false;
+  SEXP s3class = Rf_getAttrib(times, Rf_install(".S3Class"));
+  if (TYPEOF(s3class) != STRSXP) return false;
+  for (R_xlen_t k = 0; k < XLENGTH(s3class); k++)
+    if (strcmp(CHAR(STRING_ELT(s3class, k)), "integer64") == 0) return true;
+  return false;
+}
+
+// The 64-bit integers of such a vector, none of which may be NA_integer64
+inline int64_t *int64_times(SEXP times) {
+  int64_t *ticks = reinterpret_cast<int64_t*>(REAL(times));
+  for (R_xlen_t i = 0; i < XLENGTH(times); i++)
+    if (ticks[i] == INT64_MIN) Rcpp::stop("Non-missing integer times needed.");
+  return ticks;
+}
+
+// Window width in whole time units, with INT64_MAX for an infinite width
+inline int64_t int64_width(double width) {
+  if (!(width >= 0)) Rcpp::stop("Non-negative window widths needed.");
+  return (width >= 9.2e18) ? INT64_MAX : (int64_t) llround(width);
+}
+
+// Window width or decay factor passed from R, either as a double or as an integer64 scalar such as a
+// nanoduration, whose bits are decoded here instead of being read as a double
+class TimeWidth {
+public:
+  TimeWidth(SEXP width) : ticks(0), exact(is_int64_times(width)) {
+    if (XLENGTH(width) != 1) Rcpp::stop("Expecting a single value.");
+    if (exact) {
+      ticks = reinterpret_cast<int64_t*>(REAL(width))[0];
+      if (ticks == INT64_MIN) Rcpp::stop("Non-missing window widths needed.");
+      value = (double) ticks;
+    } else
+      value = Rcpp::as<double>(width);
+  }
+
+  operator double() const { return value; }
+
+  // The width as a double, for kernels taking their parameters by pointer
+  double *ptr() const { return const_cast<double*>(&value); }
+
+  // Width in whole time units, with INT64_MAX for an infinite width
+  int64_t int64() const {
+    if (!exact) return int64_width(value);
+    if (ticks < 0) Rcpp::stop("Non-negative window widths needed.");
+    return ticks;
+  }
+
+private:
+  double value;
+  int64_t ticks;
+  bool exact;
+};
+
+#endif
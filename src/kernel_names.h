@@ -0,0 +1,169 @@
+// Rolling and SMA kernels and statistics by the names used for them in the R functions
+
+#ifndef _kernel_names_h
+#define _kernel_names_h
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "rolling.h"
+#include "sma.h"
+}
+
+#include <RcppUTS/sliding_window.h>
+
+// Rolling kernel of the operation 'stat', e.g. rolling_mean for "mean"
+inline rolling_kernel rolling_kernel_named(const std::string& stat) {
+  static const struct { const char *name; rolling_kernel kernel; } kernels[] = {
+    { "kurtosis", rolling_kurtosis }, { "max", rolling_max }, { "mean", rolling_mean },
+    { "median", rolling_median }, { "min", rolling_min }, { "nobs", rolling_num_obs },
+    { "product", rolling_product }, { "logproduct", rolling_log_product }, { "sd", rolling_sd },
+    { "skewness", rolling_skewness }, { "sum", rolling_sum }, { "sumstable", rolling_sum_stable },
+    { "var", rolling_var }
+  };
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    if (stat == kernels[k].name) return kernels[k].kernel;
+  Rcpp::stop("Unknown rolling operation '" + stat + "'.");
+  return NULL;
+}
+
+// Rolling kernel over a window index of the operation 'stat', e.g. rolling_mean_window for "mean"
+inline rolling_window_kernel rolling_window_kernel_named(const std::string& stat) {
+  static const struct { const char *name; rolling_window_kernel kernel; } kernels[] = {
+    { "kurtosis", rolling_kurtosis_window }, { "max", rolling_max_window }, { "mean", rolling_mean_window },
+    { "median", rolling_median_window }, { "min", rolling_min_window }, { "nobs", rolling_num_obs_window },
+    { "product", rolling_product_window }, { "logproduct", rolling_log_product_window },
+    { "sd", rolling_sd_window }, { "skewness", rolling_skewness_window }, { "sum", rolling_sum_window },
+    { "sumstable", rolling_sum_stable_window }, { "var", rolling_var_window }
+  };
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    if (stat == kernels[k].name) return kernels[k].kernel;
+  Rcpp::stop("Unknown rolling operation '" + stat + "'.");
+  return NULL;
+}
+
+// Rolling kernel of two series over a window index of the operation 'stat', i.e. "cov", "cor" or "beta"
+inline rolling_pair_window_kernel rolling_pair_window_kernel_named(const std::string& stat) {
+  if (stat == "cov") return rolling_cov_window;
+  if (stat == "cor") return rolling_cor_window;
+  if (stat == "beta") return rolling_beta_window;
+  Rcpp::stop("Unknown rolling operation '" + stat + "'.");
+  return NULL;
+}
+
+// Check probabilities and name them as quantile() does
+inline Rcpp::CharacterVector quantile_names(Rcpp::NumericVector probs) {
+  Rcpp::CharacterVector names(probs.size());
+  for (int j = 0; j < probs.size(); j++) {
+    if (!(probs[j] >= 0 && probs[j] <= 1)) Rcpp::stop("Probabilities must be between 0 and 1.");
+    char name[32];
+    snprintf(name, sizeof(name), "%.7g%%", 100 * probs[j]);
+    names[j] = name;
+  }
+  return names;
+}
+
+// SMA kernel of the interpolation 'type', i.e. "last", "next" or "linear"
+inline rolling_kernel sma_kernel_named(const std::string& type) {
+  if (type == "last") return sma_last;
+  if (type == "next") return sma_next;
+  if (type == "linear") return sma_linear;
+  Rcpp::stop("Unknown SMA type '" + type + "'.");
+  return NULL;
+}
+
+// SMA kernel over the rolling windows of a window index
+typedef void (*sma_window_kernel)(double values[], double times[], window_index *index, double values_new[],
+                                  double *width_before, double *width_after);
+
+// SMA kernel over a window index of the interpolation 'type'
+inline sma_window_kernel sma_window_kernel_named(const std::string& type) {
+  if (type == "last") return sma_last_window;
+  if (type == "next") return sma_next_window;
+  if (type == "linear") return sma_linear_window;
+  Rcpp::stop("Unknown SMA type '" + type + "'.");
+  return NULL;
+}
+
+// Name of the k-th statistic of rolling_summary, in the order of its output columns
+inline const char *summary_name(int k) {
+  static const char *names[] = { "nobs", "sum", "mean", "var", "min", "max" };
+  return names[k];
+}
+
+// Bit mask of the rolling_summary statistics named in 'stats', e.g. SUMMARY_MEAN for "mean"
+inline int summary_stats_named(Rcpp::CharacterVector stats) {
+  int mask = 0;
+  for (int j = 0; j < stats.size(); j++) {
+    std::string stat(stats[j]);
+    int k = 0;
+    while (k < 6 && stat != summary_name(k)) k++;
+    if (k == 6) Rcpp::stop("Unknown statistic '" + stat + "'.");
+    mask |= 1 << k;
+  }
+  return mask;
+}
+
+// Apply a rolling or SMA kernel for several rolling windows, recycling widths of length one
+inline Rcpp::NumericMatrix rolling_apply_multi(rolling_multi_kernel kernel,
+                                               Rcpp::DatetimeVector times,
+                                               Rcpp::NumericVector values,
+                                               Rcpp::NumericVector widthbefore,
+                                               Rcpp::NumericVector widthafter) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  R_xlen_t n = times.size();
+  R_xlen_t k = std::max(widthbefore.size(), widthafter.size());
+  if ((widthbefore.size() != k && widthbefore.size() != 1) ||
+      (widthafter.size() != k && widthafter.size() != 1))
+    Rcpp::stop("Matching window widths needed.");
+  if (k > INT_MAX) Rcpp::stop("Too many window widths for the columns of a matrix.");
+  std::vector<double> before(k), after(k);
+  for (R_xlen_t j = 0; j < k; j++) {
+    before[j] = widthbefore[(widthbefore.size() == 1) ? 0 : j];
+    after[j] = widthafter[(widthafter.size() == 1) ? 0 : j];
+  }
+  Rcpp::NumericMatrix res(n, (int) k);
+  if (k > 0)
+    kernel(values.begin(), times.begin(), &n, res.begin(), &before[0], &after[0], &k);
+  return res;
+}
+
+// Output matrix of rolling_summary with one named column per statistic in 'mask'
+inline Rcpp::NumericMatrix summary_matrix(R_xlen_t m, int mask) {
+  int ncol = 0;
+  for (int k = 0; k < 6; k++)
+    if (mask & (1 << k)) ncol++;
+  Rcpp::NumericMatrix res(m, ncol);
+  Rcpp::CharacterVector colnames(ncol);
+  for (int k = 0, col = 0; k < 6; k++)
+    if (mask & (1 << k)) colnames[col++] = summary_name(k);
+  res.attr("dimnames") = Rcpp::List::create(R_NilValue, colnames);
+  return res;
+}
+
+// Apply rolling_aggregate_windows for the monoid of the operation 'op', e.g. sum_monoid for "sum"
+template <class Windows>
+inline void rolling_aggregate_named(const std::string& op, double *values, R_xlen_t n, double *out,
+                                    const Windows& windows) {
+  ptrdiff_t len = n;
+  if (op == "sum")
+    rolling_aggregate_windows(values, &len, out, windows, sum_monoid());
+  else if (op == "prod")
+    rolling_aggregate_windows(values, &len, out, windows, product_monoid());
+  else if (op == "min")
+    rolling_aggregate_windows(values, &len, out, windows, min_monoid());
+  else if (op == "max")
+    rolling_aggregate_windows(values, &len, out, windows, max_monoid());
+  else if (op == "any")
+    rolling_aggregate_windows(values, &len, out, windows, any_monoid());
+  else if (op == "all")
+    rolling_aggregate_windows(values, &len, out, windows, all_monoid());
+  else
+    Rcpp::stop("Unknown operation '" + op + "'.");
+}
+
+#endif
@@ -3,24 +3,40 @@
 
 #include <math.h>
 #include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "rolling.h"
+#include "tdigest.h"
 
 #ifndef SWAP
 #  define SWAP(a,b) {temp=(a); (a)=(b); (b)=temp;}
 #endif
 
+// Number of matrix columns processed together by the *_matrix functions, also in sma.c
+// -) the accumulators of a block are updated from MATRIX_BLOCK column streams in step; a row-interleaved copy of
+//    the block would let the column loops vectorize, but costs more than it saves for these memory-bound updates
+#define MATRIX_BLOCK 8
+
+// Kernels shared by the time windows and the windows of a window index, see rolling_windows
+#if defined(__GNUC__)
+#  define WINDOWS_KERNEL static inline __attribute__((always_inline)) void
+#else
+#  define WINDOWS_KERNEL static inline void
+#endif
+
 
 /******************* Helper functions ********************/
 
 // Return smallest element of an array (defined as +infinity for empty array)
-static inline double array_min(double values[], int n)
+static inline double array_min(double values[], ptrdiff_t n)
 {
   // values ... array of values
   // n      ... length of array
   
   double min_value = INFINITY;
   
-  for (int i = 0; i < n; i++) {
+  for (ptrdiff_t i = 0; i < n; i++) {
     if (values[i] < min_value)
       min_value = values[i];
   }
@@ -33,7 +49,7 @@ Find the k-th largest element (counting starts at zero) of an array using the "q
 -) O(N) average case performance
 -) the input array will be rearranged
 */
-double quickselect(double values[], int n, int k)
+double quickselect(double values[], ptrdiff_t n, ptrdiff_t k)
 {
   // values ... array of values
   // n      ... length of array
@@ -42,7 +58,7 @@ double quickselect(double values[], int n, int k)
   if (k >= n)
     return NAN;
   
-  int i, j, left, right, mid;
+  ptrdiff_t i, j, left, right, mid;
   double pivot, temp;
   left = 0;
   right = n - 1;
@@ -94,7 +110,7 @@ double quickselect(double values[], int n, int k)
 
 
 // Find the median value of an array (which gets scrambled)
-double median(double values[], int n)
+double median(double values[], ptrdiff_t n)
 {
   // values ... array of values
   // n      ... length of array
@@ -105,8 +121,8 @@ double median(double values[], int n)
     return NAN;
   
   // Determine the mid points of the array
-  int mid_low = (n - 1) / 2;
-  int mid_high = n - mid_low - 1;
+  ptrdiff_t mid_low = (n - 1) / 2;
+  ptrdiff_t mid_high = n - mid_low - 1;
   value_low = quickselect(values, n, mid_low);
   
   if (mid_low < mid_high) {   // even number of elements -> two mid points
@@ -135,29 +151,294 @@ static inline void compensated_addition(double *sum, double addend, double *comp
 
 
 
+/*
+Indexed pair of heaps for calculating the median of a rolling window
+-) 'low' is a max-heap holding the lower half of the window, 'high' is a min-heap holding the upper half
+-) 'heap_pos' tracks the position of each observation inside its heap, so that observations leaving the
+   window can be removed directly in O(log w) time instead of relying on lazy deletion
+-) invariant: the size of 'low' is equal to, or one larger than, the size of 'high'
+*/
+typedef struct {
+  double *values;           // array of time series values (not owned)
+  ptrdiff_t *low;           // max-heap of observation indices
+  ptrdiff_t *high;          // min-heap of observation indices
+  ptrdiff_t n_low;          // number of observations in 'low'
+  ptrdiff_t n_high;         // number of observations in 'high'
+  ptrdiff_t *heap_pos;      // position of each observation within its heap
+  char *in_low;             // 1 if observation is stored in 'low', 0 if stored in 'high'
+} median_heaps;
+
+
+// Check whether observation a has to be placed closer to the root than observation b
+static inline int heap_before(double values[], ptrdiff_t a, ptrdiff_t b, int is_low)
+{
+  return is_low ? (values[a] > values[b]) : (values[a] < values[b]);
+}
+
+
+// Swap two heap entries and keep track of their positions
+static inline void heap_swap(median_heaps *h, ptrdiff_t heap[], ptrdiff_t pos1, ptrdiff_t pos2)
+{
+  ptrdiff_t temp = heap[pos1];
+  heap[pos1] = heap[pos2];
+  heap[pos2] = temp;
+  h->heap_pos[heap[pos1]] = pos1;
+  h->heap_pos[heap[pos2]] = pos2;
+}
+
+
+// Move an element up the heap until the heap property is restored
+static void heap_sift_up(median_heaps *h, ptrdiff_t heap[], ptrdiff_t pos, int is_low)
+{
+  ptrdiff_t parent;
+  
+  while (pos > 0) {
+    parent = (pos - 1) / 2;
+    if (!heap_before(h->values, heap[pos], heap[parent], is_low))
+      break;
+    heap_swap(h, heap, pos, parent);
+    pos = parent;
+  }
+}
+
+
+// Move an element down the heap until the heap property is restored
+static void heap_sift_down(median_heaps *h, ptrdiff_t heap[], ptrdiff_t size, ptrdiff_t pos, int is_low)
+{
+  ptrdiff_t child;
+  
+  while ((child = 2 * pos + 1) < size) {
+    if ((child + 1 < size) && heap_before(h->values, heap[child + 1], heap[child], is_low))
+      child++;
+    if (!heap_before(h->values, heap[child], heap[pos], is_low))
+      break;
+    heap_swap(h, heap, pos, child);
+    pos = child;
+  }
+}
+
+
+// Append an observation to one of the two heaps
+static void heap_push(median_heaps *h, ptrdiff_t j, int is_low)
+{
+  ptrdiff_t *heap = is_low ? h->low : h->high;
+  ptrdiff_t *size = is_low ? &h->n_low : &h->n_high;
+  
+  heap[*size] = j;
+  h->heap_pos[j] = *size;
+  h->in_low[j] = (char) is_low;
+  (*size)++;
+  heap_sift_up(h, heap, *size - 1, is_low);
+}
+
+
+// Remove the element at a given position from one of the two heaps
+static void heap_delete(median_heaps *h, ptrdiff_t pos, int is_low)
+{
+  ptrdiff_t *heap = is_low ? h->low : h->high;
+  ptrdiff_t *size = is_low ? &h->n_low : &h->n_high;
+  
+  (*size)--;
+  if (pos == *size)
+    return;
+  heap[pos] = heap[*size];
+  h->heap_pos[heap[pos]] = pos;
+  heap_sift_down(h, heap, *size, pos, is_low);
+  heap_sift_up(h, heap, pos, is_low);
+}
+
+
+// Restore the size invariant by moving the root of one heap to the other heap
+static void median_rebalance(median_heaps *h)
+{
+  ptrdiff_t j;
+  
+  if (h->n_low > h->n_high + 1) {
+    j = h->low[0];
+    heap_delete(h, 0, 1);
+    heap_push(h, j, 0);
+  } else if (h->n_high > h->n_low) {
+    j = h->high[0];
+    heap_delete(h, 0, 0);
+    heap_push(h, j, 1);
+  }
+}
+
+
+// Add an observation to the rolling window, skipping NaN values which would break the heap ordering
+static void median_add(median_heaps *h, ptrdiff_t j)
+{
+  if (isnan(h->values[j]))
+    return;
+  if ((h->n_low == 0) || (h->values[j] <= h->values[h->low[0]]))
+    heap_push(h, j, 1);
+  else
+    heap_push(h, j, 0);
+  median_rebalance(h);
+}
+
+
+// Remove an observation from the rolling window
+static void median_remove(median_heaps *h, ptrdiff_t j)
+{
+  if (isnan(h->values[j]))
+    return;
+  heap_delete(h, h->heap_pos[j], h->in_low[j]);
+  median_rebalance(h);
+}
+
+
+// Median of the observations currently in the rolling window
+static inline double median_value(median_heaps *h)
+{
+  if (h->n_low == 0)
+    return NAN;
+  if (h->n_low > h->n_high)   // odd number of elements
+    return h->values[h->low[0]];
+  return (h->values[h->low[0]] + h->values[h->high[0]]) / 2;
+}
+
+
+
+// Reset the power sums of a rolling window to an empty window
+void moment_sums_reset(moment_sums *ms, double shift)
+{
+  // ms    ... power sums
+  // shift ... value subtracted from each observation before taking powers
+  
+  ms->shift = shift;
+  for (int k = 0; k < 4; k++)
+    ms->sum[k] = ms->comp[k] = 0;
+}
+
+
+// Add (sign = 1) or remove (sign = -1) an observation to the power sums
+void moment_sums_update(moment_sums *ms, double value, double sign)
+{
+  double d = value - ms->shift, p = sign * d;
+  
+  for (int k = 0; k < 4; k++) {
+    compensated_addition(&ms->sum[k], p, &ms->comp[k]);
+    p = p * d;
+  }
+}
+
+
+// Recalculate the power sums of values[left], ..., values[right] around their mean
+void moment_sums_rebase(moment_sums *ms, double values[], ptrdiff_t left, ptrdiff_t right)
+{
+  if (left <= right)
+    moment_sums_reset(ms, ms->shift + ms->sum[0] / (right - left + 1));
+  else
+    moment_sums_reset(ms, ms->shift);
+  for (ptrdiff_t pos = left; pos <= right; pos++)
+    moment_sums_update(ms, values[pos], 1);
+}
+
+
+// Sums of the second, third and fourth power of the deviations from the window mean
+void moment_sums_central(moment_sums *ms, ptrdiff_t count, double *m2, double *m3, double *m4)
+{
+  double a = ms->sum[0] / count, a2 = a * a;
+  
+  *m2 = ms->sum[1] - a * ms->sum[0];
+  *m3 = ms->sum[2] - 3 * a * ms->sum[1] + 2 * a2 * ms->sum[0];
+  *m4 = ms->sum[3] - 4 * a * ms->sum[2] + 6 * a2 * ms->sum[1] - 3 * a2 * a * ms->sum[0];
+  
+  // Treat variation below the rounding error of the power sums as zero (e.g. for a constant window)
+  if (*m2 <= 1e-14 * ms->sum[1])
+    *m2 = *m3 = *m4 = 0;
+  if (*m4 < 0)
+    *m4 = 0;
+}
+
+
+
+/*
+Rolling windows of the kernels below: either the time windows (t_i - width_before, t_i + width_after] of the
+observation times, or the windows stored in a window index
+-) the window of observation i extends on the right while its next observation is within window_right_bound()
+   and window_includes() holds, and is shrunk on the left while its first observation is before
+   window_left_bound() and window_excludes() holds; for time windows the bounds are those of the time series,
+   and for the windows of an index the conditions always hold, so that the times are not needed at all
+-) the kernels are written once for both kinds of windows and inlined into both of their entry points, where
+   the kind of windows is a constant, so that the conditions reduce to those of the original time kernels
+-) the kernels calculate one output value per window; the windows of an index can also be those of query times,
+   so that their number may differ from the number of observations 'n', and a window may be empty
+*/
+typedef struct {
+  ptrdiff_t n;            // number of observations
+  double *times;          // observation times, for time windows
+  double *width_before;   // width of rolling window before t_i, for time windows
+  double *width_after;    // width of rolling window after t_i, for time windows
+  window_index *index;    // precomputed windows, or NULL for time windows
+} rolling_windows;
+
+
+static inline rolling_windows windows_of_times(double times[], ptrdiff_t *n, double *width_before,
+  double *width_after)
+{
+  rolling_windows windows = { *n, times, width_before, width_after, NULL };
+  return windows;
+}
+
+
+static inline rolling_windows windows_of_index(window_index *index)
+{
+  rolling_windows windows = { index->num_obs, NULL, NULL, NULL, index };
+  return windows;
+}
+
+
+// Last position that the rolling window of observation i may extend to on the right
+static inline ptrdiff_t window_right_bound(rolling_windows *windows, ptrdiff_t i)
+{
+  return (windows->index != NULL) ? window_index_right(windows->index, i) : windows->n - 1;
+}
+
+
+// Position that the rolling window of observation i may be shrunk to on the left
+static inline ptrdiff_t window_left_bound(rolling_windows *windows, ptrdiff_t i)
+{
+  return (windows->index != NULL) ? window_index_left(windows->index, i) : windows->n;
+}
+
+
+// Whether the rolling window of observation i includes the observation at position 'pos' within its bound
+static inline int window_includes(rolling_windows *windows, ptrdiff_t pos, ptrdiff_t i)
+{
+  return (windows->index != NULL) || (windows->times[pos] <= windows->times[i] + *windows->width_after);
+}
+
+
+// Whether the rolling window of observation i excludes the observation at position 'pos' within its bound
+static inline int window_excludes(rolling_windows *windows, ptrdiff_t pos, ptrdiff_t i)
+{
+  return (windows->index != NULL) || (windows->times[pos] <= windows->times[i] - *windows->width_before);
+}
+
+
+
 /****************** END: Helper functions ****************/
 
 
 // Rolling number of observation values
-void rolling_num_obs(double values[], double times[], int *n, double values_new[],
-  double *width_before, double *width_after)
+WINDOWS_KERNEL rolling_num_obs_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows)
 {
   // values       ... array of time series values
-  // times        ... array of observation times
-  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // n            ... number of windows, i.e. of output values
   // values_new   ... array of length *n to store output time series values
-  // width_before ... (non-negative) width of rolling window before t_i
-  // width_after  ... (non-negative) width of rolling window after t_i
+  // windows      ... rolling windows of the observations, see rolling_windows
   
-  int left = 0, right = -1;
+  ptrdiff_t left = 0, right = -1;
   
-  for (int i = 0; i < *n; i++) {
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after))
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i))
       right++;
     
     // Shrink window on the left
-    while ((left < *n) && (times[left] <= times[i] - *width_before))
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i))
       left++;
     
     // Number of observations is equal to length of window
@@ -166,8 +447,8 @@ void rolling_num_obs(double values[], double times[], int *n, double values_new[
 }
 
 
-// Rolling sum of observation values
-void rolling_sum(double values[], double times[], int *n, double values_new[],
+// Rolling number of observation values
+void rolling_num_obs(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
@@ -177,18 +458,43 @@ void rolling_sum(double values[], double times[], int *n, double values_new[],
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = -1;
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_num_obs_over(values, n, values_new, &windows);
+}
+
+
+// Rolling number of observation values, for the windows of a window index
+void rolling_num_obs_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_num_obs_over(values, &index->n, values_new, &windows);
+}
+
+
+// Rolling sum of observation values
+WINDOWS_KERNEL rolling_sum_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  
+  ptrdiff_t left = 0, right = -1;
   double roll_sum = 0;
   
-  for (int i = 0; i < *n; i++) {
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after)) {
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
       right++;
       roll_sum = roll_sum + values[right];
     }
     
     // Shrink window on the left
-    while ((left < *n) && (times[left] <= times[i] - *width_before)) {
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
       roll_sum = roll_sum - values[left];
       left++;
     }
@@ -199,8 +505,8 @@ void rolling_sum(double values[], double times[], int *n, double values_new[],
 }
 
 
-// Same as rolling_sum, but use Kahan (1965) summation algorithm to reduce numerical error
-void rolling_sum_stable(double values[], double times[], int *n, double values_new[],
+// Rolling sum of observation values
+void rolling_sum(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
@@ -210,18 +516,44 @@ void rolling_sum_stable(double values[], double times[], int *n, double values_n
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = -1;
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_sum_over(values, n, values_new, &windows);
+}
+
+
+// Rolling sum of observation values, for the windows of a window index
+void rolling_sum_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_sum_over(values, &index->n, values_new, &windows);
+}
+
+
+// Same as rolling_sum, but use Kahan (1965) summation algorithm to reduce numerical error
+WINDOWS_KERNEL rolling_sum_stable_over(double values[], ptrdiff_t *n, double values_new[],
+  rolling_windows *windows)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  
+  ptrdiff_t left = 0, right = -1;
   double roll_sum = 0, comp = 0;
   
-  for (int i = 0; i < *n; i++) {
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after)) {
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
       right++;
       compensated_addition(&roll_sum, values[right], &comp);
     }
     
     // Shrink window on the left
-    while ((left < *n) && (times[left] <= times[i] - *width_before)) {
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
       compensated_addition(&roll_sum, -values[left], &comp);
       left++;
     }
@@ -232,9 +564,8 @@ void rolling_sum_stable(double values[], double times[], int *n, double values_n
 }
 
 
-
-// Rolling product of observation values
-void rolling_product(double values[], double times[], int *n, double values_new[],
+// Same as rolling_sum, but use Kahan (1965) summation algorithm to reduce numerical error
+void rolling_sum_stable(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
@@ -244,42 +575,143 @@ void rolling_product(double values[], double times[], int *n, double values_new[
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = -1, most_recent_zero = -1;
-  double roll_product = 1;
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_sum_stable_over(values, n, values_new, &windows);
+}
+
+
+// Same as rolling_sum_stable, for the windows of a window index
+void rolling_sum_stable_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_sum_stable_over(values, &index->n, values_new, &windows);
+}
+
+
+
+// Multiply a product, given by its mantissa and binary exponent, by a value and return the new mantissa
+// -) the mantissa is only rescaled (exactly, by a power of two) if it leaves the range [2^-500, 2^500]
+static inline double scaled_multiply(double mantissa, int *exponent, double value)
+{
+  double product = mantissa * value;
+  int e1, e2, e3;
+  
+  if ((fabs(product) <= 0x1p+500) && ((fabs(product) >= 0x1p-500) || (product == 0 && (mantissa == 0 || value == 0))))
+    return product;
+  product = frexp(frexp(mantissa, &e1) * frexp(value, &e2), &e3);
+  *exponent = *exponent + e1 + e2 + e3;
+  return product;
+}
+
+
+/*
+Rolling product of observation values, or the logarithm of its absolute value
+-) the rolling window is kept in two stacks: for the older observations the products of each observation and
+   all later ones in the older stack, for the newer observations their running product; whenever the older
+   stack is empty, all observations are moved to it, so that each observation is multiplied a constant number
+   of times and no division is needed, in particular when a zero leaves the window
+-) products are kept as a mantissa and a binary exponent, so that they neither overflow nor underflow inside
+   the window
+*/
+WINDOWS_KERNEL rolling_products(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows,
+  int log_scale)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  // log_scale    ... whether to return the logarithm of the absolute value of the product
+  
+  ptrdiff_t left = 0, right = -1, flip = 0;
+  int exponent, back_exponent = 0, *suffix_exponent;
+  double mantissa, back_mantissa = 1, *suffix_mantissa;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Products of values[pos], ..., values[flip - 1] for pos < flip, and of values[flip], ..., values[right]
+  suffix_mantissa = malloc(windows->n * sizeof(double));
+  suffix_exponent = malloc(windows->n * sizeof(int));
   
-  for (int i = 0; i < *n; i++) {
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after)) {
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
       right++;
-      roll_product = roll_product * values[right];
-      
-      // Save position of most recent zero
-      if ((values[right] > -1e-10) && (values[right] < 1e-10))
-        most_recent_zero = right;
+      back_mantissa = scaled_multiply(back_mantissa, &back_exponent, values[right]);
     }
     
     // Shrink window on the left
-    while ((left < *n) && (times[left] <= times[i] - *width_before)) {
-      // Don't need to update rolling product if zero drops out, because calculated from scratch below
-      if ((values[left] < -1e-10) || (values[left] > 1e-10))
-        roll_product = roll_product / values[left];
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i))
       left++;
+    
+    // Move all observations to the older stack once it is empty
+    if (left >= flip) {
+      mantissa = 1;
+      exponent = 0;
+      for (ptrdiff_t pos = right; pos >= left; pos--) {
+        mantissa = scaled_multiply(mantissa, &exponent, values[pos]);
+        suffix_mantissa[pos] = mantissa;
+        suffix_exponent[pos] = exponent;
+      }
+      flip = (left > right) ? left : right + 1;
+      back_mantissa = 1;
+      back_exponent = 0;
     }
     
-    // Update rolling product
-    // -) need to calculate from scratch in case a zero dropped out of the window
-    if ((roll_product == 0) && (most_recent_zero < left)) {
-      roll_product = 1;
-      for (int pos=left; pos <= right; pos++)
-        roll_product = roll_product * values[pos];
+    // Combine the two stacks
+    mantissa = back_mantissa;
+    exponent = back_exponent;
+    if (left < flip) {
+      exponent = exponent + suffix_exponent[left];
+      mantissa = scaled_multiply(mantissa, &exponent, suffix_mantissa[left]);
     }
-    values_new[i] = roll_product;
+    if (log_scale)
+      values_new[i] = log(fabs(mantissa)) + exponent * M_LN2;
+    else
+      values_new[i] = (exponent == 0) ? mantissa : ldexp(mantissa, exponent);
   }
+  
+  free(suffix_mantissa);
+  free(suffix_exponent);
 }
 
 
-// Rolling average of observation values
-void rolling_mean(double values[], double times[], int *n, double values_new[],
+// Rolling product of observation values
+void rolling_product(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_products(values, n, values_new, &windows, 0);
+}
+
+
+// Rolling product of observation values, for the windows of a window index
+void rolling_product_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_products(values, &index->n, values_new, &windows, 0);
+}
+
+
+// Logarithm of the absolute value of the rolling product of observation values
+// -) e.g. the log return over the rolling window for observation values equal to gross returns
+void rolling_log_product(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
@@ -289,18 +721,43 @@ void rolling_mean(double values[], double times[], int *n, double values_new[],
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = -1;
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_products(values, n, values_new, &windows, 1);
+}
+
+
+// Same as rolling_log_product, for the windows of a window index
+void rolling_log_product_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_products(values, &index->n, values_new, &windows, 1);
+}
+
+
+// Rolling average of observation values
+WINDOWS_KERNEL rolling_mean_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  
+  ptrdiff_t left = 0, right = -1;
   double roll_sum = 0;
   
-  for (int i = 0; i < *n; i++) {
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after)) {
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
       right++;
       roll_sum = roll_sum + values[right];
     }
     
     // Shrink window on the left to get half-open interval
-    while ((left < *n) && (times[left] <= times[i] - *width_before)) {
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
       roll_sum = roll_sum - values[left];
       left++;
     }
@@ -314,169 +771,1213 @@ void rolling_mean(double values[], double times[], int *n, double values_new[],
 }
 
 
-// Rolling maximum of observation values
-void rolling_max(double values[], double times[], int *n, double values_new[],
+// Rolling average of observation values
+void rolling_mean(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
-  // times        ... array of observation times matching time series values
-  // n            ... length of 'values'
-  // values_new   ... array (of same length as 'values') used to store output
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int j, left = 0, right = -1, max_pos = 0;
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_mean_over(values, n, values_new, &windows);
+}
+
+
+// Rolling average of observation values, for the windows of a window index
+void rolling_mean_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
   
-  for (int i = 0; i < *n; i++) {
-    // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after)) {
-      right++;
-      if (values[right] >= values[max_pos])
-        max_pos = right;
-    }
-    
-    // Shrink window on the left to get half-open interval
-    while ((left < *n) && (times[left] <= times[i] - *width_before))
-      left++;      
-    
-    // Recalculate position of maximum if old maximum dropped out
-    // Inline functionality of max_index() to avoid function call overhead
-    if (max_pos < left) {
-      max_pos = left;
-      for (j = left+1; j <= right; j++)
-        if (values[j] >= values[max_pos])
-          max_pos = j;
-    }
-    
-    // Save maximum in current time window
-    if (left <= right)  // non-empty window
-      values_new[i] = values[max_pos];
-    else                // empty window
-      values_new[i] = -INFINITY;
-  }
+  rolling_windows windows = windows_of_index(index);
+  rolling_mean_over(values, &index->n, values_new, &windows);
 }
 
 
-// Rolling minimum of observation values
-void rolling_min(double values[], double times[], int *n, double values_new[],
+// Positions of the first and last observation in the rolling window of each observation time
+void rolling_window_bounds(double times[], ptrdiff_t *n, ptrdiff_t left[], ptrdiff_t right[],
   double *width_before, double *width_after)
 {
-  // values       ... array of time series values
-  // times        ... array of observation times matching time series values
-  // n            ... length of 'values'
-  // values_new   ... array (of same length as 'values') used to store output
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'times'
+  // left         ... array of length *n to store the position of the first observation in each window
+  // right        ... array of length *n to store the position of the last observation in each window
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_window_bounds_capped(times, n, left, right, width_before, width_after, n, n);
+}
+
+
+// Positions of the first and last observation in rolling windows limited by both time and number of observations
+
+void rolling_window_bounds_capped(double times[], ptrdiff_t *n, ptrdiff_t left[], ptrdiff_t right[],
+  double *width_before, double *width_after, ptrdiff_t *n_before, ptrdiff_t *n_after)
+{
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'times'
+  // left         ... array of length *n to store the position of the first observation in each window
+  // right        ... array of length *n to store the position of the last observation in each window
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
+  // n_before     ... (non-negative) maximum number of observations before position i in the window
+  // n_after      ... (non-negative) maximum number of observations after position i in the window
+  
+  /* The window of observation i consists of the observations in the time window of rolling_window_bounds,
+     further limited to the positions i - *n_before to i + *n_after
+     -) an infinite width gives a pure count window, e.g. the last k observations for *n_before = k - 1 and
+        *n_after = 0, and *n_before = *n_after = *n gives a pure time window
+     -) both window ends are still non-decreasing in i, so the incremental updates of the rolling kernels keep
+        working unchanged
+     -) a limit on the right end can leave it before the first observation of the time window, e.g. for
+        *width_before = 0 and tied times beyond i + *n_after; the window is then empty, with its left end
+        stopped at right + 1 so that no observation is removed before it was added
+  */
   
-  int j, left = 0, right = -1, min_pos = 0;
+  ptrdiff_t l = 0, r = -1;
   
-  for (int i = 0; i < *n; i++) {   
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after)) {
-      right++;
-      if (values[right] <= values[min_pos])
-        min_pos = right;
-    }
+    while ((r < *n - 1) && (r - i < *n_after) && (times[r + 1] <= times[i] + *width_after))
+      r++;
     
-    // Shrink window on the left to get half-open interval
-    while ((left < *n) && (times[left] <= times[i] - *width_before))
-      left++;      
+    // Shrink window on the left, but not past its right end
+    while ((l <= r) && ((i - l > *n_before) || (times[l] <= times[i] - *width_before)))
+      l++;
     
-    // Recalculate position of minimum if old minimum dropped out
-    // Inline the calculation of the minimum position to avoid any function call overhead
-    if (min_pos < left) {
-      min_pos = left;
-      for (j = left+1; j <= right; j++)
-        if (values[j] <= values[min_pos])
-          min_pos = j;
-    }
+    left[i] = l;
+    right[i] = r;
+  }
+}
+
+
+// Rolling sum or average of each column of a matrix, with all columns sharing the same observation times
+// -) the window boundaries are determined once and then applied to blocks of MATRIX_BLOCK columns at a time
+static void rolling_sum_columns(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after, int average)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // average      ... calculate the rolling average (1) or the rolling sum (0)
+  
+  ptrdiff_t *left, *right;
+  double roll_sum[MATRIX_BLOCK];
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Determine the rolling windows
+  left = malloc(*n * sizeof(ptrdiff_t));
+  right = malloc(*n * sizeof(ptrdiff_t));
+  rolling_window_bounds(times, n, left, right, width_before, width_after);
+  
+  for (int col = 0; col < *ncol; col += MATRIX_BLOCK) {
+    int num_cols = (*ncol - col < MATRIX_BLOCK) ? *ncol - col : MATRIX_BLOCK;
+    ptrdiff_t l = 0, r = -1, count;
+    double *x = values + (size_t) col * *n, *out = values_new + (size_t) col * *n;
+    
+    for (int b = 0; b < num_cols; b++)
+      roll_sum[b] = 0;
+    
+    for (ptrdiff_t i = 0; i < *n; i++) {
+      // Expand window on the right
+      for (; r < right[i]; r++) {
+        for (int b = 0; b < num_cols; b++)
+          roll_sum[b] = roll_sum[b] + x[(size_t) b * *n + r + 1];
+      }
+      
+      // Shrink window on the left
+      for (; l < left[i]; l++) {
+        for (int b = 0; b < num_cols; b++)
+          roll_sum[b] = roll_sum[b] - x[(size_t) b * *n + l];
+      }
+      
+      // Save rolling sum or average
+      count = right[i] - left[i] + 1;
+      for (int b = 0; b < num_cols; b++) {
+        if (!average)
+          out[(size_t) b * *n + i] = roll_sum[b];
+        else if (count > 0)  // non-empty window
+          out[(size_t) b * *n + i] = roll_sum[b] / count;
+        else                 // empty window
+          out[(size_t) b * *n + i] = NAN;
+      }
+    }
+  }
+  free(left);
+  free(right);
+}
+
+
+// Rolling sum of each column of a matrix of observation values
+void rolling_sum_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_sum_columns(values, times, n, ncol, values_new, width_before, width_after, 0);
+}
+
+
+// Rolling average of each column of a matrix of observation values
+void rolling_mean_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_sum_columns(values, times, n, ncol, values_new, width_before, width_after, 1);
+}
+
+
+// Rolling mean or standard deviation for several window widths, see rolling_multi_kernel in rolling.h
+// -) each window keeps its own power sums, so the results equal those of rolling_mean and rolling_sd
+static void rolling_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows, int sd)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  // sd           ... calculate the rolling standard deviation (1) or the rolling mean (0)
+  
+  ptrdiff_t *left, *right, *rebase_pos, count;
+  double *roll_sum, *out, m2, m3, m4;
+  moment_sums *ms;
+  
+  // Trivial case
+  if ((*n == 0) || (*num_windows == 0))
+    return;
+  
+  // State of each rolling window
+  left = malloc(*num_windows * sizeof(ptrdiff_t));
+  right = malloc(*num_windows * sizeof(ptrdiff_t));
+  rebase_pos = malloc(*num_windows * sizeof(ptrdiff_t));
+  roll_sum = malloc(*num_windows * sizeof(double));
+  ms = malloc(*num_windows * sizeof(moment_sums));
+  for (ptrdiff_t k = 0; k < *num_windows; k++) {
+    left[k] = 0;
+    right[k] = rebase_pos[k] = -1;
+    roll_sum[k] = 0;
+    moment_sums_reset(&ms[k], 0);
+  }
+  
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    for (ptrdiff_t k = 0; k < *num_windows; k++) {
+      ptrdiff_t l = left[k], r = right[k];
+      double sum = roll_sum[k];
+      
+      // Expand window on the right
+      while ((r < *n - 1) && (times[r + 1] <= times[i] + width_after[k])) {
+        r++;
+        if (sd)
+          moment_sums_update(&ms[k], values[r], 1);
+        else
+          sum = sum + values[r];
+      }
+      
+      // Shrink window on the left
+      while ((l < *n) && (times[l] <= times[i] - width_before[k])) {
+        if (!sd)
+          sum = sum - values[l];
+        else if (l <= r)
+          moment_sums_update(&ms[k], values[l], -1);
+        l++;
+      }
+      left[k] = l;
+      right[k] = r;
+      roll_sum[k] = sum;
+      count = r - l + 1;
+      out = values_new + (size_t) k * *n + i;
+      
+      // Calculate mean of values in rolling window
+      if (!sd) {
+        *out = (count > 0) ? sum / count : NAN;
+        continue;
+      }
+      
+      // Recalculate the power sums once all observations of the last rebase have dropped out
+      if (l > rebase_pos[k]) {
+        moment_sums_rebase(&ms[k], values, l, r);
+        rebase_pos[k] = r;
+      }
+      
+      // Calculate standard deviation of values in rolling window
+      if (count < 2) {   // less than two observations in time window
+        *out = NAN;
+        continue;
+      }
+      moment_sums_central(&ms[k], count, &m2, &m3, &m4);
+      *out = sqrt(m2 / (count - 1));
+    }
+  }
+  
+  free(left);
+  free(right);
+  free(rebase_pos);
+  free(roll_sum);
+  free(ms);
+}
+
+
+// Rolling average of observation values for several rolling windows
+void rolling_mean_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  
+  rolling_multi(values, times, n, values_new, width_before, width_after, num_windows, 0);
+}
+
+
+// Rolling standard deviation of observation values for several rolling windows
+void rolling_sd_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  
+  rolling_multi(values, times, n, values_new, width_before, width_after, num_windows, 1);
+}
+
+
+// Rolling maximum of observation values
+// -) candidate positions are kept in a monotonic deque, so each observation is added and removed at most once
+WINDOWS_KERNEL rolling_max_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  
+  ptrdiff_t left = 0, right = -1, head = 0, tail = 0;
+  ptrdiff_t *deque;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Positions of candidates for the maximum, with decreasing values from head to tail
+  // -) every position is appended only once, so the deque never wraps around
+  deque = malloc(windows->n * sizeof(ptrdiff_t));
+  
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    // Expand window on the right
+    // -) drop candidates dominated by the new observation; for ties the most recent position is kept
+    // -) NaN values are skipped, as they would never be dropped by later values
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
+      right++;
+      if (isnan(values[right]))
+        continue;
+      while ((tail > head) && (values[right] >= values[deque[tail - 1]]))
+        tail--;
+      deque[tail++] = right;
+    }
+    
+    // Shrink window on the left to get half-open interval
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i))
+      left++;
+    
+    // Drop candidates that are no longer in the window
+    while ((head < tail) && (deque[head] < left))
+      head++;
+    
+    // Save maximum in current time window
+    if (head < tail)    // non-empty window
+      values_new[i] = values[deque[head]];
+    else                // empty window
+      values_new[i] = -INFINITY;
+  }
+  free(deque);
+}
+
+
+// Rolling maximum of observation values
+void rolling_max(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times matching time series values
+  // n            ... length of 'values'
+  // values_new   ... array (of same length as 'values') used to store output
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_max_over(values, n, values_new, &windows);
+}
+
+
+// Rolling maximum of observation values, for the windows of a window index
+void rolling_max_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_max_over(values, &index->n, values_new, &windows);
+}
+
+
+// Rolling minimum of observation values
+// -) candidate positions are kept in a monotonic deque, so each observation is added and removed at most once
+WINDOWS_KERNEL rolling_min_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  
+  ptrdiff_t left = 0, right = -1, head = 0, tail = 0;
+  ptrdiff_t *deque;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Positions of candidates for the minimum, with increasing values from head to tail
+  // -) every position is appended only once, so the deque never wraps around
+  deque = malloc(windows->n * sizeof(ptrdiff_t));
+  
+  for (ptrdiff_t i = 0; i < *n; i++) {   
+    // Expand window on the right
+    // -) drop candidates dominated by the new observation; for ties the most recent position is kept
+    // -) NaN values are skipped, as they would never be dropped by later values
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
+      right++;
+      if (isnan(values[right]))
+        continue;
+      while ((tail > head) && (values[right] <= values[deque[tail - 1]]))
+        tail--;
+      deque[tail++] = right;
+    }
+    
+    // Shrink window on the left to get half-open interval
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i))
+      left++;
+    
+    // Drop candidates that are no longer in the window
+    while ((head < tail) && (deque[head] < left))
+      head++;
+    
+    // Save minium in current time window
+    if (head < tail)    // non-empty window
+      values_new[i] = values[deque[head]];
+    else                // empty window
+      values_new[i] = INFINITY;
+  }
+  free(deque);
+}
+
+
+// Rolling minimum of observation values
+void rolling_min(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times matching time series values
+  // n            ... length of 'values'
+  // values_new   ... array (of same length as 'values') used to store output
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_min_over(values, n, values_new, &windows);
+}
+
+
+// Rolling minimum of observation values, for the windows of a window index
+void rolling_min_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_min_over(values, &index->n, values_new, &windows);
+}
+
+
+// Rolling median
+// -) the window is kept in an indexed pair of heaps, so each update costs O(log w) instead of O(w)
+WINDOWS_KERNEL rolling_median_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  
+  ptrdiff_t left = 0, right = -1;
+  median_heaps h;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Allocate the heaps on the heap instead of the stack to support long time series
+  h.values = values;
+  h.low = malloc(windows->n * sizeof(ptrdiff_t));
+  h.high = malloc(windows->n * sizeof(ptrdiff_t));
+  h.heap_pos = malloc(windows->n * sizeof(ptrdiff_t));
+  h.in_low = malloc(windows->n * sizeof(char));
+  h.n_low = h.n_high = 0;
+
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    // Expand window on the right
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
+      right++;
+      median_add(&h, right);
+    }
+    
+    // Shrink window on the left end
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
+      if (left <= right)
+        median_remove(&h, left);
+      left++;
+    }
+    
+    // Calculate the median of the current window
+    values_new[i] = median_value(&h);
+  }
+  
+  free(h.low);
+  free(h.high);
+  free(h.heap_pos);
+  free(h.in_low);
+}
+
+
+// Rolling median
+void rolling_median(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times matching time series values
+  // n            ... length of 'values'
+  // values_new   ... array (of same length as 'values') used to store output
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_median_over(values, n, values_new, &windows);
+}
+
+
+// Rolling median, for the windows of a window index
+void rolling_median_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_median_over(values, &index->n, values_new, &windows);
+}
+
+
+/*
+Order statistics of a rolling window using a Fenwick (binary indexed) tree over the value ranks of a stretch of
+observations around the window
+-) the observations from the left end of the window up to about twice its length are ranked (ties broken by
+   position), and the tree counts the observations of the window per rank; once the window reaches the end of
+   the stretch, a new stretch is ranked starting at the left end of the window
+-) each stretch is at least twice as long as the window it starts with, so ranking it is paid for by the window
+   advancing over its second half, and adding or removing an observation and finding the k-th smallest window
+   value take O(log w) amortized time and O(w) memory; all quantiles of a window share the same tree
+-) NaN values are not ranked, i.e. the quantiles are those of the other window values
+*/
+typedef struct {
+  double value;
+  ptrdiff_t pos;
+} ranked_value;
+
+typedef struct {
+  ptrdiff_t start;          // position of the first ranked observation
+  ptrdiff_t end;            // position after the last ranked observation
+  ptrdiff_t num_ranks;      // number of ranks, i.e. of ranked observations other than NaN
+  ptrdiff_t capacity;       // length of the arrays below
+  ptrdiff_t *rank;          // rank of each observation of the stretch, or -1 for NaN
+  double *sorted;           // values of the stretch in increasing order
+  ptrdiff_t *tree;          // Fenwick tree counting the window observations per rank
+  ranked_value *order;      // workspace for sorting the stretch
+} ranked_stretch;
+
+
+// Order of two values other than NaN, with ties broken by position
+static int ranked_value_compare(const void *a, const void *b)
+{
+  const ranked_value *x = a, *y = b;
+  
+  if (x->value != y->value)
+    return (x->value < y->value) ? -1 : 1;
+  return (x->pos < y->pos) ? -1 : (x->pos > y->pos);
+}
+
+
+// Add 'delta' to the count of rank r (counting starts at zero)
+static inline void fenwick_update(ptrdiff_t tree[], ptrdiff_t n, ptrdiff_t r, int delta)
+{
+  for (r++; r <= n; r += r & (-r))
+    tree[r - 1] += delta;
+}
+
+
+// Rank of the k-th smallest counted element (counting starts at one)
+static inline ptrdiff_t fenwick_select(ptrdiff_t tree[], ptrdiff_t n, ptrdiff_t k)
+{
+  ptrdiff_t pos = 0, step = 1;
+  
+  while (2 * step <= n)
+    step *= 2;
+  for (; step > 0; step /= 2) {
+    if ((pos + step <= n) && (tree[pos + step - 1] < k)) {
+      pos += step;
+      k -= tree[pos - 1];
+    }
+  }
+  return pos;
+}
+
+
+// Rank a new stretch starting with the window [left, right], and count the window observations in its tree
+static void ranked_stretch_start(ranked_stretch *s, double values[], ptrdiff_t n, ptrdiff_t left,
+  ptrdiff_t right)
+{
+  ptrdiff_t len = 2 * (right - left + 1) + 64, m = 0;
+  
+  s->start = left;
+  s->end = (len < n - left) ? left + len : n;
+  len = s->end - s->start;
+  if (len > s->capacity) {
+    s->capacity = 2 * len;
+    s->rank = realloc(s->rank, s->capacity * sizeof(ptrdiff_t));
+    s->sorted = realloc(s->sorted, s->capacity * sizeof(double));
+    s->tree = realloc(s->tree, s->capacity * sizeof(ptrdiff_t));
+    s->order = realloc(s->order, s->capacity * sizeof(ranked_value));
+  }
+  
+  // Rank the values other than NaN
+  for (ptrdiff_t j = s->start; j < s->end; j++) {
+    s->rank[j - s->start] = -1;
+    if (!isnan(values[j])) {
+      s->order[m].value = values[j];
+      s->order[m].pos = j;
+      m++;
+    }
+  }
+  qsort(s->order, m, sizeof(ranked_value), ranked_value_compare);
+  for (ptrdiff_t r = 0; r < m; r++) {
+    s->rank[s->order[r].pos - s->start] = r;
+    s->sorted[r] = s->order[r].value;
+    s->tree[r] = 0;
+  }
+  s->num_ranks = m;
+  
+  for (ptrdiff_t j = left; j <= right; j++)
+    if (s->rank[j - s->start] >= 0)
+      fenwick_update(s->tree, m, s->rank[j - s->start], 1);
+}
+
+
+// Add (delta = 1) or remove (delta = -1) an observation of the stretch, and return the change of the count
+static inline int ranked_stretch_update(ranked_stretch *s, ptrdiff_t j, int delta)
+{
+  ptrdiff_t r = s->rank[j - s->start];
+  
+  if (r < 0)
+    return 0;
+  fenwick_update(s->tree, s->num_ranks, r, delta);
+  return delta;
+}
+
+
+// Rolling quantiles of observation values, using the definitions of R's quantile() function
+WINDOWS_KERNEL rolling_quantile_over(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows,
+  double probs[], int *num_probs, int *type)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... column-major matrix with *n rows and *num_probs columns to store output
+  // windows      ... rolling windows of the observations, see rolling_windows
+  // probs        ... array of probabilities between zero and one
+  // num_probs    ... number of probabilities
+  // type         ... quantile definition (1, ..., 9), see the help of R's quantile() function
+  
+  // Parameters a and b of the continuous quantile types 4, ..., 9
+  static const double type_a[] = { 0, 0.5, 0, 1, 1.0 / 3, 3.0 / 8 };
+  static const double type_b[] = { 1, 0.5, 0, 1, 1.0 / 3, 3.0 / 8 };
+  const double fuzz = 4 * 2.220446e-16;
+  
+  ptrdiff_t left = 0, right = -1, count = 0, j;
+  double nppm, h, low, high;
+  ranked_stretch s = { 0, 0, 0, 0, NULL, NULL, NULL, NULL };
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    // Expand window on the right, ranking a new stretch once the window reaches the end of the current one
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
+      right++;
+      if (right >= s.end)
+        ranked_stretch_start(&s, values, windows->n, (left < right) ? left : right, right - 1);
+      count += ranked_stretch_update(&s, right, 1);
+    }
+    
+    // Shrink window on the left
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
+      if (left <= right)
+        count += ranked_stretch_update(&s, left, -1);
+      left++;
+    }
+    
+    // Calculate the requested quantiles of the current window
+    for (int k = 0; k < *num_probs; k++) {
+      if (count < 1) {
+        values_new[i + k * *n] = NAN;
+        continue;
+      }
+      
+      // Position j + h between the order statistics j and j + 1 (counting starts at one)
+      if (*type <= 3) {
+        nppm = (*type == 3) ? count * probs[k] - 0.5 : count * probs[k];
+        j = (ptrdiff_t) floor(nppm + fuzz);
+        if (*type == 1)
+          h = (nppm > j + fuzz);
+        else if (*type == 2)
+          h = ((nppm > j + fuzz) + 1) / 2.0;
+        else
+          h = (fabs(nppm - j) > fuzz) || (j % 2 != 0);
+      } else {
+        nppm = type_a[*type - 4] + probs[k] * (count + 1 - type_a[*type - 4] - type_b[*type - 4]);
+        j = (ptrdiff_t) floor(nppm + fuzz);
+        h = nppm - j;
+        if (fabs(h) < fuzz)
+          h = 0;
+      }
+      
+      // Interpolate between the order statistics, which are truncated to the window
+      low = s.sorted[fenwick_select(s.tree, s.num_ranks, (j < 1) ? 1 : ((j > count) ? count : j))];
+      if (h == 0)
+        values_new[i + k * *n] = low;
+      else {
+        high = s.sorted[fenwick_select(s.tree, s.num_ranks, (j + 1 < 1) ? 1 : ((j + 1 > count) ? count : j + 1))];
+        values_new[i + k * *n] = ((h == 1) || (low == high)) ? high : (1 - h) * low + h * high;
+      }
+    }
+  }
+  
+  free(s.rank);
+  free(s.sorted);
+  free(s.tree);
+  free(s.order);
+}
+
+
+// Rolling quantiles of observation values, using the definitions of R's quantile() function
+void rolling_quantile(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after, double probs[], int *num_probs, int *type)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_probs columns to store output
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // probs        ... array of probabilities between zero and one
+  // num_probs    ... number of probabilities
+  // type         ... quantile definition (1, ..., 9), see the help of R's quantile() function
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_quantile_over(values, n, values_new, &windows, probs, num_probs, type);
+}
+
+
+// Rolling quantiles of observation values, for the windows of a window index
+void rolling_quantile_window(double values[], window_index *index, double values_new[], double probs[],
+  int *num_probs, int *type)
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... column-major matrix with index->n rows and *num_probs columns to store output
+  // probs        ... array of probabilities between zero and one
+  // num_probs    ... number of probabilities
+  // type         ... quantile definition (1, ..., 9), see the help of R's quantile() function
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_quantile_over(values, &index->n, values_new, &windows, probs, num_probs, type);
+}
+
+// Replace the older-stack digests of buckets first, ..., open - 1 by the union of the bucket and all later ones
+// -) moves all closed buckets of rolling_quantile_approx to the older stack, and returns the new value of 'flip'
+static ptrdiff_t digest_stack_flip(tdigest own[], tdigest suffix[], int num_slots, ptrdiff_t first, ptrdiff_t open,
+  tdigest *back)
+{
+  for (ptrdiff_t b = open - 1; b >= first; b--) {
+    tdigest_copy(&suffix[b % num_slots], &own[b % num_slots]);
+    if (b < open - 1)
+      tdigest_merge(&suffix[b % num_slots], &suffix[(b + 1) % num_slots], 1);
+  }
+  tdigest_reset(back);
+  return open;
+}
+
+
+/*
+Approximate rolling quantiles of observation values using t-digests of time buckets
+-) the observations are grouped into time buckets of width (width_before + width_after) / num_buckets, each
+   summarized by a t-digest; the buckets in the rolling window are kept in two stacks, with the union of each
+   bucket and all later ones in the older stack and the union of all buckets in the newer one, so that each
+   bucket is merged a constant number of times
+-) the rolling window contains the same observations as for rolling_quantile; the oldest bucket of a window
+   usually lies only partly inside the window, and is included with its weights scaled to the number of its
+   observations still inside, which adds a rank error of at most about 1 / num_buckets
+-) memory is O(num_buckets * compression) instead of O(window length), at a cost of O(compression) per
+   output value
+-) for the windows of a window index, which has no observation times, the buckets instead hold consecutive
+   observations, num_buckets to the longest window
+*/
+WINDOWS_KERNEL rolling_quantile_approx_over(double values[], ptrdiff_t *n, double values_new[],
+  rolling_windows *windows, double probs[], int *num_probs, double *compression, int *num_buckets)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... column-major matrix with *n rows and *num_probs columns to store output
+  // windows      ... rolling windows of the observations, see rolling_windows
+  // probs        ... array of probabilities between zero and one
+  // num_probs    ... number of probabilities
+  // compression  ... accuracy parameter of the t-digests (e.g. 100)
+  // num_buckets  ... number of time buckets per window width, or per longest window of an index (positive)
+  
+  ptrdiff_t left = 0, right = -1, start, open_first = -1;
+  int buckets = (*num_buckets > 1) ? *num_buckets : 1, num_slots, oldest, partial, num_parts, num_rest;
+  int rest_partial = 0;
+  ptrdiff_t first = 0, open = 0, flip = 0, cell, open_cell = 0;   // bucket numbers
+  ptrdiff_t rest_first = -1, rest_open = -1, rest_flip = -1, bucket_size = 1;
+  ptrdiff_t *bucket_first, *bucket_last;
+  double bucket_width = 0, scales[3], rest_scales[2];
+  tdigest *own, *suffix, back, current, rest, window, *parts[3], *rest_parts[2];
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Closed buckets 'first', ..., 'open' - 1 are stored in slot (bucket number % num_slots); 'own' holds their
+  // digests, 'suffix' the older stack for buckets before 'flip', and 'back' the union of the other closed
+  // buckets; the open bucket 'open' receives the observations entering the window
+  num_slots = buckets + 3;
+  if (windows->index == NULL)
+    bucket_width = (*windows->width_before + *windows->width_after) / buckets;
+  else {
+    // Buckets of consecutive observations, with 'buckets' of them to the longest window
+    for (ptrdiff_t i = 0; i < *n; i++) {
+      start = window_index_right(windows->index, i) - window_index_left(windows->index, i) + 1;
+      if (start > bucket_size)
+        bucket_size = start;
+    }
+    bucket_size = (bucket_size + buckets - 1) / buckets;
+  }
+  bucket_first = malloc(num_slots * sizeof(ptrdiff_t));
+  bucket_last = malloc(num_slots * sizeof(ptrdiff_t));
+  own = malloc(num_slots * sizeof(tdigest));
+  suffix = malloc(num_slots * sizeof(tdigest));
+  for (int s = 0; s < num_slots; s++) {
+    tdigest_init(&own[s], *compression);
+    tdigest_init(&suffix[s], *compression);
+  }
+  tdigest_init(&back, *compression);
+  tdigest_init(&current, *compression);
+  tdigest_init(&rest, *compression);
+  tdigest_init(&window, *compression);
+  
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    // Shrink window on the left
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i))
+      left++;
     
-    // Save minium in current time window
-    if (left <= right)  // non-empty window
-      values_new[i] = values[min_pos];
-    else                // empty window
-      values_new[i] = INFINITY;
+    // Expand window on the right, closing the open bucket whenever an observation falls into a later bucket
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
+      right++;
+      if (right < left)
+        continue;
+      if (windows->index != NULL)
+        cell = right / bucket_size;
+      else if (bucket_width > 0)
+        cell = (ptrdiff_t) floor((windows->times[right] - windows->times[0]) / bucket_width);
+      else
+        cell = right;
+      if ((open_first >= 0) && (cell != open_cell)) {
+        // Drop buckets that have left the window, to make room for the closed bucket
+        while ((first < open) && (bucket_last[first % num_slots] < left)) {
+          if (flip <= first)
+            flip = digest_stack_flip(own, suffix, num_slots, first, open, &back);
+          first++;
+        }
+        bucket_first[open % num_slots] = open_first;
+        bucket_last[open % num_slots] = right - 1;
+        tdigest_compress(&current);
+        tdigest_copy(&own[open % num_slots], &current);
+        tdigest_merge(&back, &current, 1);
+        open++;
+        tdigest_reset(&current);
+        open_first = -1;
+      }
+      if (open_first < 0) {
+        open_first = right;
+        open_cell = cell;
+      }
+      tdigest_add(&current, values[right], 1);
+    }
+    
+    // Drop buckets that have left the window
+    while ((first < open) && (bucket_last[first % num_slots] < left)) {
+      if (flip <= first)
+        flip = digest_stack_flip(own, suffix, num_slots, first, open, &back);
+      first++;
+    }
+    
+    // Trivial case: empty window
+    if (right < left) {
+      for (int k = 0; k < *num_probs; k++)
+        values_new[i + k * *n] = NAN;
+      continue;
+    }
+    
+    // Digests of the window, with the weights of a partly included oldest bucket scaled down
+    // -) the union of the closed buckets apart from a partly included oldest one only changes with the buckets
+    num_parts = 0;
+    if (first < open) {
+      oldest = (int) (first % num_slots);
+      start = (bucket_first[oldest] < left) ? left : bucket_first[oldest];
+      partial = (start > bucket_first[oldest]);
+      if (partial && (flip <= first))
+        flip = digest_stack_flip(own, suffix, num_slots, first, open, &back);
+      if ((first != rest_first) || (open != rest_open) || (flip != rest_flip) || (partial != rest_partial)) {
+        num_rest = 0;
+        if (first + partial < flip) {
+          rest_parts[num_rest] = &suffix[(first + partial) % num_slots];
+          rest_scales[num_rest++] = 1;
+        }
+        rest_parts[num_rest] = &back;
+        rest_scales[num_rest++] = 1;
+        tdigest_union(&rest, rest_parts, rest_scales, num_rest);
+        rest_first = first;
+        rest_open = open;
+        rest_flip = flip;
+        rest_partial = partial;
+      }
+      parts[num_parts] = &rest;
+      scales[num_parts++] = 1;
+      if (partial) {
+        parts[num_parts] = &own[oldest];
+        scales[num_parts++] = (double) (bucket_last[oldest] - start + 1) / (bucket_last[oldest] - bucket_first[oldest] + 1);
+      }
+      parts[num_parts] = &current;
+      scales[num_parts++] = 1;
+    } else {
+      start = (open_first < left) ? left : open_first;
+      parts[num_parts] = &current;
+      scales[num_parts++] = (double) (right - start + 1) / (right - open_first + 1);
+    }
+    tdigest_union(&window, parts, scales, num_parts);
+    
+    // Calculate the requested quantiles of the current window
+    for (int k = 0; k < *num_probs; k++)
+      values_new[i + k * *n] = tdigest_quantile(&window, probs[k]);
+  }
+  
+  for (int s = 0; s < num_slots; s++) {
+    tdigest_free(&own[s]);
+    tdigest_free(&suffix[s]);
   }
+  tdigest_free(&back);
+  tdigest_free(&current);
+  tdigest_free(&rest);
+  tdigest_free(&window);
+  free(own);
+  free(suffix);
+  free(bucket_first);
+  free(bucket_last);
 }
 
 
-// Rolling median
-void rolling_median(double values[], double times[], int *n, double values_new[], 
-  double *width_before, double *width_after)
+// Approximate rolling quantiles of observation values
+void rolling_quantile_approx(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after, double probs[], int *num_probs, double *compression,
+  int *num_buckets)
 {
   // values       ... array of time series values
-  // times        ... array of observation times matching time series values
-  // n            ... length of 'values'
-  // values_new   ... array (of same length as 'values') used to store output
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_probs columns to store output
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
+  // probs        ... array of probabilities between zero and one
+  // num_probs    ... number of probabilities
+  // compression  ... accuracy parameter of the t-digests (e.g. 100)
+  // num_buckets  ... number of time buckets per window width (positive)
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_quantile_approx_over(values, n, values_new, &windows, probs, num_probs, compression, num_buckets);
+}
+
+
+// Approximate rolling quantiles of observation values, for the windows of a window index
+void rolling_quantile_approx_window(double values[], window_index *index, double values_new[], double probs[],
+  int *num_probs, double *compression, int *num_buckets)
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... column-major matrix with index->n rows and *num_probs columns to store output
+  // probs        ... array of probabilities between zero and one
+  // num_probs    ... number of probabilities
+  // compression  ... accuracy parameter of the t-digests (e.g. 100)
+  // num_buckets  ... number of buckets per longest window (positive)
   
-  int j, window_length, left = 0, right = -1;
-  double values_tmp[*n];      // temporary array for median(), which shuffles the input data 
+  rolling_windows windows = windows_of_index(index);
+  rolling_quantile_approx_over(values, &index->n, values_new, &windows, probs, num_probs, compression,
+    num_buckets);
+}
+
+
+// Statistics calculated by rolling_moments()
+#define MOMENT_CENTRAL  0
+#define MOMENT_SKEWNESS 1
+#define MOMENT_KURTOSIS 2
 
-  for (int i = 0; i < *n; i++) {
+
+// Rolling moments based on incrementally updated power sums
+WINDOWS_KERNEL rolling_moments(double values[], ptrdiff_t *n, double values_new[], rolling_windows *windows, int m,
+  int stat)
+{
+  // values       ... array of time series values
+  // n            ... number of windows, i.e. of output values
+  // values_new   ... array of length *n to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  // m            ... which central moment to calculate (1, 2, 3, or 4), if stat is MOMENT_CENTRAL
+  // stat         ... MOMENT_CENTRAL, MOMENT_SKEWNESS, or MOMENT_KURTOSIS
+  
+  ptrdiff_t count, left = 0, right = -1, rebase_pos = -1;
+  double m2, m3, m4;
+  moment_sums ms;
+  
+  moment_sums_reset(&ms, 0);
+  
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after))
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
       right++;
+      moment_sums_update(&ms, values[right], 1);
+    }
     
-    // Shrink window on the left end
-    while ((left < *n) && (times[left] <= times[i] - *width_before))
+    // Shrink window on the left
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
+      if (left <= right)
+        moment_sums_update(&ms, values[left], -1);
       left++;
+    }
+    
+    // Recalculate the power sums once all observations of the last rebase have dropped out
+    // -) bounds the accumulated rounding error at amortized O(1) cost per update
+    if (left > rebase_pos) {
+      moment_sums_rebase(&ms, values, left, right);
+      rebase_pos = right;
+    }
     
-    // Copy data in rolling window to temporary array, then calculate the median
-    window_length = right - left + 1;
-    for (j = 0; j < window_length; j++)
-      values_tmp[j] = values[left + j];
-    values_new[i] = median(values_tmp, window_length);
+    // Calculate the requested statistic in current time window
+    count = right - left + 1;
+    if (count < 2) {   // less than two observations in time window
+      values_new[i] = NAN;
+      continue;
+    }
+    moment_sums_central(&ms, count, &m2, &m3, &m4);
+    if (stat == MOMENT_SKEWNESS)
+      values_new[i] = (m2 > 0) ? sqrt(count) * m3 / (m2 * sqrt(m2)) : NAN;
+    else if (stat == MOMENT_KURTOSIS)
+      values_new[i] = (m2 > 0) ? count * m4 / (m2 * m2) - 3 : NAN;
+    else if (m == 1)   // deviations from the mean sum to zero
+      values_new[i] = 0;
+    else
+      values_new[i] = ((m == 2) ? m2 : ((m == 3) ? m3 : m4)) / (count - 1);
   }
 }
 
 
 // Rolling central moment of observation values
-void rolling_central_moment(double values[], double times[], int *n, double values_new[],
-  double *width_before, double *width_after, double *m)
+// -) for m = 1, 2, 3, 4 the moments are calculated from incrementally updated power sums in O(1) per update
+// -) for other values of m, the deviations from the rolling mean are summed over the whole window
+WINDOWS_KERNEL rolling_central_moment_over(double values[], ptrdiff_t *n, double values_new[],
+  rolling_windows *windows, double *m)
 {
   // values       ... array of time series values
-  // times        ... array of observation times
-  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // n            ... number of windows, i.e. of output values
   // values_new   ... array of length *n to store output time series values
-  // width_before ... (non-negative) width of rolling window before t_i
-  // width_after  ... (non-negative) width of rolling window after t_i
+  // windows      ... rolling windows of the observations, see rolling_windows
   // m            ... which moment to calculate (non-negative number)
   
-  int left = 0, right = -1;
-  double tmp;
+  ptrdiff_t left = 0, right = -1;
+  double tmp, mean, roll_sum = 0;
   
-  // Calculate the rolling first moment
-  double *rolling_1st_moment = malloc(*n * sizeof(double));
-  rolling_mean(values, times, n, rolling_1st_moment, width_before, width_after);
+  // Integer moments up to order four
+  if ((*m == 1) || (*m == 2) || (*m == 3) || (*m == 4)) {
+    rolling_moments(values, n, values_new, windows, (int) *m, MOMENT_CENTRAL);
+    return;
+  }
   
   // Calculate m-th central moment
-  for (int i = 0; i < *n; i++) {
+  for (ptrdiff_t i = 0; i < *n; i++) {
     // Expand window on the right
-    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after))
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
       right++;
+      roll_sum = roll_sum + values[right];
+    }
     
     // Shrink window on the left
-    while ((left < *n) && (times[left] <= times[i] - *width_before))
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
+      roll_sum = roll_sum - values[left];
       left++;
+    }
     
     // Calculate m-th central moment in current time window
     if (left < right) {   // two or more observations in time window
+      mean = roll_sum / (right - left + 1);
       tmp = 0;
-      for (int pos = left; pos <= right; pos++)
-        tmp = tmp + pow(values[pos] - rolling_1st_moment[i], *m);
+      for (ptrdiff_t pos = left; pos <= right; pos++)
+        tmp = tmp + pow(values[pos] - mean, *m);
       values_new[i] = tmp / (right - left);
     } else
       values_new[i] = NAN;
   }
-  free(rolling_1st_moment);
+}
+
+
+// Rolling central moment of observation values
+void rolling_central_moment(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after, double *m)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // m            ... which moment to calculate (non-negative number)
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_central_moment_over(values, n, values_new, &windows, m);
+}
+
+
+// Rolling central moment of observation values, for the windows of a window index
+void rolling_central_moment_window(double values[], window_index *index, double values_new[], double *m)
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  // m            ... which moment to calculate (non-negative number)
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_central_moment_over(values, &index->n, values_new, &windows, m);
+}
+
+
+// Rolling skewness of observation values
+void rolling_skewness(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_moments(values, n, values_new, &windows, 3, MOMENT_SKEWNESS);
+}
+
+
+// Rolling skewness of observation values, for the windows of a window index
+void rolling_skewness_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_moments(values, &index->n, values_new, &windows, 3, MOMENT_SKEWNESS);
+}
+
+
+// Rolling excess kurtosis of observation values
+void rolling_kurtosis(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_windows windows = windows_of_times(times, n, width_before, width_after);
+  rolling_moments(values, n, values_new, &windows, 4, MOMENT_KURTOSIS);
+}
+
+
+// Rolling excess kurtosis of observation values, for the windows of a window index
+void rolling_kurtosis_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_moments(values, &index->n, values_new, &windows, 4, MOMENT_KURTOSIS);
 }
 
 
 
 // Rolling standard deviation of observation values
-void rolling_sd(double values[], double times[], int *n, double values_new[],
+void rolling_sd(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
@@ -488,13 +1989,27 @@ void rolling_sd(double values[], double times[], int *n, double values_new[],
   
   double moment = 2;
   rolling_central_moment(values, times, n, values_new, width_before, width_after, &moment);
-  for (int i = 0; i < *n; i++)
+  for (ptrdiff_t i = 0; i < *n; i++)
+    values_new[i] = sqrt(values_new[i]);
+}
+
+
+// Rolling standard deviation of observation values, for the windows of a window index
+void rolling_sd_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  double moment = 2;
+  rolling_central_moment_window(values, index, values_new, &moment);
+  for (ptrdiff_t i = 0; i < index->n; i++)
     values_new[i] = sqrt(values_new[i]);
 }
 
 
 // Rolling variance of observation values
-void rolling_var(double values[], double times[], int *n, double values_new[],
+void rolling_var(double values[], double times[], ptrdiff_t *n, double values_new[],
   double *width_before, double *width_after)
 {
   // values       ... array of time series values
@@ -507,3 +2022,358 @@ void rolling_var(double values[], double times[], int *n, double values_new[],
   double moment = 2;
   rolling_central_moment(values, times, n, values_new, width_before, width_after, &moment);
 }
+
+
+// Rolling variance of observation values, for the windows of a window index
+void rolling_var_window(double values[], window_index *index, double values_new[])
+{
+  // values       ... array of time series values
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  double moment = 2;
+  rolling_central_moment_window(values, index, values_new, &moment);
+}
+
+
+#define COMOMENT_COV 0
+#define COMOMENT_COR 1
+#define COMOMENT_BETA 2
+
+
+// Sums of the first and second (co-)powers of two series in a rolling window, around a shift value
+typedef struct {
+  double shift_x, shift_y;
+  double sum[5];      // sums of dx, dy, dx^2, dy^2, dx * dy for dx = x - shift_x and dy = y - shift_y
+  double comp[5];     // accumulated numeric errors of the sums
+} comoment_sums;
+
+
+static void comoment_sums_reset(comoment_sums *cs, double shift_x, double shift_y)
+{
+  cs->shift_x = shift_x;
+  cs->shift_y = shift_y;
+  for (int k = 0; k < 5; k++)
+    cs->sum[k] = cs->comp[k] = 0;
+}
+
+
+// Add (sign = 1) or remove (sign = -1) a pair of observations to the sums
+static void comoment_sums_update(comoment_sums *cs, double x, double y, double sign)
+{
+  double dx = x - cs->shift_x, dy = y - cs->shift_y;
+  
+  compensated_addition(&cs->sum[0], sign * dx, &cs->comp[0]);
+  compensated_addition(&cs->sum[1], sign * dy, &cs->comp[1]);
+  compensated_addition(&cs->sum[2], sign * dx * dx, &cs->comp[2]);
+  compensated_addition(&cs->sum[3], sign * dy * dy, &cs->comp[3]);
+  compensated_addition(&cs->sum[4], sign * dx * dy, &cs->comp[4]);
+}
+
+
+// Recalculate the sums of the pairs at positions left, ..., right around their means
+static void comoment_sums_rebase(comoment_sums *cs, double x[], double y[], ptrdiff_t left, ptrdiff_t right)
+{
+  if (left <= right)
+    comoment_sums_reset(cs, cs->shift_x + cs->sum[0] / (right - left + 1),
+      cs->shift_y + cs->sum[1] / (right - left + 1));
+  else
+    comoment_sums_reset(cs, cs->shift_x, cs->shift_y);
+  for (ptrdiff_t pos = left; pos <= right; pos++)
+    comoment_sums_update(cs, x[pos], y[pos], 1);
+}
+
+
+/*
+Rolling co-moments of pairs of observation values based on incrementally updated sums
+-) pairs before position 'first' are excluded, e.g. those before the first observation of the second time
+   series of rolling_comoments
+-) O(n) total cost, with the sums recalculated whenever all pairs of the last recalculation have left the
+   window, as in rolling_moments
+*/
+WINDOWS_KERNEL rolling_comoments_over(double values_x[], double y[], ptrdiff_t *n_x, ptrdiff_t first,
+  double values_new[], rolling_windows *windows, int stat)
+{
+  // values_x     ... array of time series values of the first time series
+  // y            ... array of the paired values of the second time series
+  // n_x          ... number of pairs, i.e. length of 'values_x' and 'y'
+  // first        ... position of the first pair to include
+  // values_new   ... array of length *n_x to store output time series values
+  // windows      ... rolling windows of the observations, see rolling_windows
+  // stat         ... COMOMENT_COV, COMOMENT_COR, or COMOMENT_BETA
+  
+  ptrdiff_t count, left = 0, right = -1, rebase_pos = -1;
+  double sx, sy, vx, vy, cxy;
+  comoment_sums cs;
+  
+  comoment_sums_reset(&cs, 0, 0);
+  
+  for (ptrdiff_t i = 0; i < *n_x; i++) {
+    // Expand window on the right
+    while ((right < window_right_bound(windows, i)) && window_includes(windows, right + 1, i)) {
+      right++;
+      if (right >= first)
+        comoment_sums_update(&cs, values_x[right], y[right], 1);
+    }
+    
+    // Shrink window on the left
+    while ((left < window_left_bound(windows, i)) && window_excludes(windows, left, i)) {
+      if ((left >= first) && (left <= right))
+        comoment_sums_update(&cs, values_x[left], y[left], -1);
+      left++;
+    }
+    
+    // Recalculate the sums once all pairs of the last rebase have dropped out, or the first pairs have entered
+    if ((left > rebase_pos) || (rebase_pos < first)) {
+      comoment_sums_rebase(&cs, values_x, y, (left > first) ? left : first, right);
+      rebase_pos = right;
+    }
+    
+    // Calculate the requested statistic in current time window
+    count = right - ((left > first) ? left : first) + 1;
+    if (count < 2) {   // less than two pairs in time window
+      values_new[i] = NAN;
+      continue;
+    }
+    sx = cs.sum[0] / count;
+    sy = cs.sum[1] / count;
+    vx = cs.sum[2] - sx * cs.sum[0];
+    vy = cs.sum[3] - sy * cs.sum[1];
+    cxy = cs.sum[4] - sx * cs.sum[1];
+    
+    // Treat variation below the rounding error of the sums as zero (e.g. for a constant window)
+    if (vx <= 1e-14 * cs.sum[2])
+      vx = 0;
+    if (vy <= 1e-14 * cs.sum[3])
+      vy = 0;
+    if ((vx == 0) || (vy == 0))
+      cxy = 0;
+    
+    if (stat == COMOMENT_COR) {
+      values_new[i] = ((vx > 0) && (vy > 0)) ? cxy / sqrt(vx * vy) : NAN;
+      if (values_new[i] > 1)
+        values_new[i] = 1;
+      else if (values_new[i] < -1)
+        values_new[i] = -1;
+    } else if (stat == COMOMENT_BETA)
+      values_new[i] = (vy > 0) ? cxy / vy : NAN;
+    else
+      values_new[i] = cxy / (count - 1);
+  }
+}
+
+
+/*
+Rolling co-moments of two time series based on incrementally updated sums
+-) the second time series is sampled at the observation times of the first one, using its most recent
+   observation value at or before each observation time (as-of alignment), in a single merge pass
+-) the rolling windows are those of the observation times of the first time series; pairs before the
+   first observation of the second time series are excluded
+-) O(n_x + n_y) total cost
+*/
+static void rolling_comoments(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[],
+  double times_y[], ptrdiff_t *n_y, double values_new[], double *width_before, double *width_after, int stat)
+{
+  // values_x     ... array of time series values of the first time series
+  // times_x      ... array of observation times of the first time series
+  // n_x          ... number of observations of the first time series
+  // values_y     ... array of time series values of the second time series
+  // times_y      ... array of observation times of the second time series
+  // n_y          ... number of observations of the second time series
+  // values_new   ... array of length *n_x to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // stat         ... COMOMENT_COV, COMOMENT_COR, or COMOMENT_BETA
+  
+  ptrdiff_t first, j = -1;
+  double *y;
+  rolling_windows windows = windows_of_times(times_x, n_x, width_before, width_after);
+  
+  // Trivial case
+  if (*n_x == 0)
+    return;
+  
+  // Value of the second time series as of each observation time of the first one
+  y = malloc(*n_x * sizeof(double));
+  first = *n_x;
+  for (ptrdiff_t i = 0; i < *n_x; i++) {
+    while ((j < *n_y - 1) && (times_y[j + 1] <= times_x[i]))
+      j++;
+    if (j >= 0) {
+      y[i] = values_y[j];
+      if (first == *n_x)
+        first = i;
+    } else
+      y[i] = NAN;
+  }
+  
+  rolling_comoments_over(values_x, y, n_x, first, values_new, &windows, stat);
+  free(y);
+}
+
+
+// Rolling covariance of two time series
+void rolling_cov(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y,
+  double values_new[], double *width_before, double *width_after)
+{
+  // values_x     ... array of time series values of the first time series
+  // times_x      ... array of observation times of the first time series
+  // n_x          ... number of observations of the first time series
+  // values_y     ... array of time series values of the second time series
+  // times_y      ... array of observation times of the second time series
+  // n_y          ... number of observations of the second time series
+  // values_new   ... array of length *n_x to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_comoments(values_x, times_x, n_x, values_y, times_y, n_y, values_new, width_before, width_after,
+    COMOMENT_COV);
+}
+
+
+// Rolling covariance of two time series observed at the same times, for the windows of a window index
+void rolling_cov_window(double values_x[], double values_y[], window_index *index, double values_new[])
+{
+  // values_x     ... array of time series values of the first time series
+  // values_y     ... array of time series values of the second time series, at the same observation times
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_comoments_over(values_x, values_y, &index->n, 0, values_new, &windows, COMOMENT_COV);
+}
+
+
+// Rolling correlation of two time series
+void rolling_cor(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y,
+  double values_new[], double *width_before, double *width_after)
+{
+  // values_x     ... array of time series values of the first time series
+  // times_x      ... array of observation times of the first time series
+  // n_x          ... number of observations of the first time series
+  // values_y     ... array of time series values of the second time series
+  // times_y      ... array of observation times of the second time series
+  // n_y          ... number of observations of the second time series
+  // values_new   ... array of length *n_x to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_comoments(values_x, times_x, n_x, values_y, times_y, n_y, values_new, width_before, width_after,
+    COMOMENT_COR);
+}
+
+
+// Rolling correlation of two time series observed at the same times, for the windows of a window index
+void rolling_cor_window(double values_x[], double values_y[], window_index *index, double values_new[])
+{
+  // values_x     ... array of time series values of the first time series
+  // values_y     ... array of time series values of the second time series, at the same observation times
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_comoments_over(values_x, values_y, &index->n, 0, values_new, &windows, COMOMENT_COR);
+}
+
+
+// Rolling beta of the first time series with respect to the second, i.e. cov(x, y) / var(y)
+void rolling_beta(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y,
+  double values_new[], double *width_before, double *width_after)
+{
+  // values_x     ... array of time series values of the first time series
+  // times_x      ... array of observation times of the first time series
+  // n_x          ... number of observations of the first time series
+  // values_y     ... array of time series values of the second time series
+  // times_y      ... array of observation times of the second time series
+  // n_y          ... number of observations of the second time series
+  // values_new   ... array of length *n_x to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  rolling_comoments(values_x, times_x, n_x, values_y, times_y, n_y, values_new, width_before, width_after,
+    COMOMENT_BETA);
+}
+
+
+// Rolling beta of two time series observed at the same times, for the windows of a window index
+void rolling_beta_window(double values_x[], double values_y[], window_index *index, double values_new[])
+{
+  // values_x     ... array of time series values of the first time series
+  // values_y     ... array of time series values of the second time series, at the same observation times
+  // index        ... window index of the observation times, see window_index.h
+  // values_new   ... array of length index->n to store output time series values
+  
+  rolling_windows windows = windows_of_index(index);
+  rolling_comoments_over(values_x, values_y, &index->n, 0, values_new, &windows, COMOMENT_BETA);
+}
+
+
+/*
+Apply a rolling kernel in parallel to chunks of the output index range
+-) each chunk locates the observations within its rolling windows by binary search, and the kernel is run
+   on the subseries consisting of the chunk plus a halo of one window width (and one observation) on each side
+-) the halo is processed by the chunk but its output discarded, so the grain size should be large relative
+   to the number of observations in a rolling window
+-) the result matches the sequential kernel up to the rounding error of the incremental updates
+*/
+void rolling_apply_parallel(rolling_kernel kernel, double values[], double times[], ptrdiff_t *n,
+  double values_new[], double *width_before, double *width_after, int *grain_size, int *num_threads)
+{
+  // kernel       ... rolling or SMA kernel, e.g. rolling_mean or sma_linear
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // grain_size   ... number of output values per chunk (if non-positive, four chunks per thread are used)
+  // num_threads  ... number of threads
+  
+  int threads = (*num_threads < 1) ? 1 : *num_threads;
+  ptrdiff_t grain, num_chunks;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Use no more threads than available
+#ifdef _OPENMP
+  if (threads > omp_get_max_threads())
+    threads = omp_get_max_threads();
+#endif
+  
+  // Determine the chunk size
+  grain = (*grain_size > 0) ? *grain_size : (*n + 4 * threads - 1) / (4 * threads);
+  num_chunks = (*n + grain - 1) / grain;
+  
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (ptrdiff_t k = 0; k < num_chunks; k++) {
+    ptrdiff_t start = k * grain, end = (start + grain < *n) ? start + grain : *n;
+    ptrdiff_t lo, hi, len, pos, step;
+    double *out;
+    
+    // Last observation before the rolling window of the first output value
+    lo = 0;
+    for (step = *n; step > 0; step /= 2) {
+      while ((lo + step < *n) && (times[lo + step] < times[start] - *width_before))
+        lo += step;
+    }
+    
+    // First observation after the rolling window of the last output value
+    hi = end - 1;
+    for (step = *n; step > 0; step /= 2) {
+      while ((hi + step < *n) && (times[hi + step] <= times[end - 1] + *width_after))
+        hi += step;
+    }
+    if (hi < *n - 1)
+      hi++;
+    
+    // Apply the kernel to the subseries and keep the output for the chunk
+    len = hi - lo + 1;
+    out = malloc(len * sizeof(double));
+    kernel(values + lo, times + lo, &len, out, width_before, width_after);
+    for (pos = start; pos < end; pos++)
+      values_new[pos] = out[pos - lo];
+    free(out);
+  }
+}
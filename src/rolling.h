@@ -5,16 +5,92 @@
 #ifndef _rolling_h
 #define _rolling_h
 
-void rolling_central_moment(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after, double *m);
-void rolling_max(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_mean(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_median(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_min(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_num_obs(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_product(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_sd(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_sum(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_sum_stable(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void rolling_var(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
+#include <stddef.h>
+#include "window_index.h"
+
+// Signature shared by the rolling and SMA kernels, used by rolling_apply_parallel()
+typedef void (*rolling_kernel)(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+
+// Signature shared by the rolling and SMA kernels for matrices of observation values
+typedef void (*rolling_matrix_kernel)(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[], double *width_before, double *width_after);
+
+// Signature shared by the rolling and SMA kernels for several rolling windows
+// -) the windows advance together in a single pass over the observations, so that each observation time and
+//    value is loaded once for all windows instead of once per window; the EMA kernels for several half-lives
+//    in ema.h work the same way
+typedef void (*rolling_multi_kernel)(double values[], double times[], ptrdiff_t *n, double values_new[], double width_before[], double width_after[], ptrdiff_t *num_windows);
+
+// Signature shared by the rolling kernels of two time series
+typedef void (*rolling_pair_kernel)(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y, double values_new[], double *width_before, double *width_after);
+
+// Signature shared by the rolling kernels for the windows of a window index
+typedef void (*rolling_window_kernel)(double values[], window_index *index, double values_new[]);
+
+// Signature shared by the rolling kernels of two time series at the same times for the windows of a window index
+typedef void (*rolling_pair_window_kernel)(double values_x[], double values_y[], window_index *index, double values_new[]);
+
+/*
+Power sums of the observations in a rolling window, used for central moments of order one to four
+-) the sums are taken around a shift value to avoid cancellation, and use compensated summation
+-) the shift should be reset to the window mean from time to time, e.g. whenever all observations present
+   at the last reset have left the window
+*/
+typedef struct {
+  double shift;       // value subtracted from each observation before taking powers
+  double sum[4];      // sums of (x - shift)^k for k = 1, ..., 4
+  double comp[4];     // accumulated numeric errors of the sums
+} moment_sums;
+
+void moment_sums_reset(moment_sums *ms, double shift);
+void moment_sums_update(moment_sums *ms, double value, double sign);
+void moment_sums_rebase(moment_sums *ms, double values[], ptrdiff_t left, ptrdiff_t right);
+void moment_sums_central(moment_sums *ms, ptrdiff_t count, double *m2, double *m3, double *m4);
+
+void rolling_window_bounds(double times[], ptrdiff_t *n, ptrdiff_t left[], ptrdiff_t right[], double *width_before, double *width_after);
+void rolling_window_bounds_capped(double times[], ptrdiff_t *n, ptrdiff_t left[], ptrdiff_t right[], double *width_before, double *width_after, ptrdiff_t *n_before, ptrdiff_t *n_after);
+void rolling_apply_parallel(rolling_kernel kernel, double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after, int *grain_size, int *num_threads);
+
+void rolling_beta(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y, double values_new[], double *width_before, double *width_after);
+void rolling_beta_window(double values_x[], double values_y[], window_index *index, double values_new[]);
+void rolling_central_moment(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after, double *m);
+void rolling_central_moment_window(double values[], window_index *index, double values_new[], double *m);
+void rolling_cor(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y, double values_new[], double *width_before, double *width_after);
+void rolling_cor_window(double values_x[], double values_y[], window_index *index, double values_new[]);
+void rolling_cov(double values_x[], double times_x[], ptrdiff_t *n_x, double values_y[], double times_y[], ptrdiff_t *n_y, double values_new[], double *width_before, double *width_after);
+void rolling_cov_window(double values_x[], double values_y[], window_index *index, double values_new[]);
+void rolling_kurtosis(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_kurtosis_window(double values[], window_index *index, double values_new[]);
+void rolling_log_product(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_log_product_window(double values[], window_index *index, double values_new[]);
+void rolling_max(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_max_window(double values[], window_index *index, double values_new[]);
+void rolling_mean(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_mean_window(double values[], window_index *index, double values_new[]);
+void rolling_mean_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[], double *width_before, double *width_after);
+void rolling_mean_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double width_before[], double width_after[], ptrdiff_t *num_windows);
+void rolling_median(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_median_window(double values[], window_index *index, double values_new[]);
+void rolling_min(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_min_window(double values[], window_index *index, double values_new[]);
+void rolling_num_obs(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_num_obs_window(double values[], window_index *index, double values_new[]);
+void rolling_product(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_product_window(double values[], window_index *index, double values_new[]);
+void rolling_quantile(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after, double probs[], int *num_probs, int *type);
+void rolling_quantile_window(double values[], window_index *index, double values_new[], double probs[], int *num_probs, int *type);
+void rolling_quantile_approx(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after, double probs[], int *num_probs, double *compression, int *num_buckets);
+void rolling_quantile_approx_window(double values[], window_index *index, double values_new[], double probs[], int *num_probs, double *compression, int *num_buckets);
+void rolling_sd(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_sd_window(double values[], window_index *index, double values_new[]);
+void rolling_sd_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double width_before[], double width_after[], ptrdiff_t *num_windows);
+void rolling_skewness(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_skewness_window(double values[], window_index *index, double values_new[]);
+void rolling_sum(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_sum_window(double values[], window_index *index, double values_new[]);
+void rolling_sum_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[], double *width_before, double *width_after);
+void rolling_sum_stable(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_sum_stable_window(double values[], window_index *index, double values_new[]);
+void rolling_var(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void rolling_var_window(double values[], window_index *index, double values_new[]);
 
 #endif
@@ -1,183 +1,840 @@
 #include <Rcpp.h>
+#include <algorithm>
 
 extern "C" {
 #include "rolling.h"
 }
 
+#include "buffers.h"
+#include "int64_times.h"
+#include "kernel_names.h"
+#include "rolling_summary.h"
+#include <RcppUTS/sliding_window.h>
+
+// Window index of the time windows further limited to 'nbefore' preceding and 'nafter' subsequent observations
+static void capped_window_index(window_index *index,
+                                Rcpp::DatetimeVector times,
+                                double widthbefore,
+                                double widthafter,
+                                double nbefore,
+                                double nafter) {
+  if (!(nbefore >= 0) || !(nafter >= 0)) Rcpp::stop("Non-negative observation counts needed.");
+  R_xlen_t n = times.size();
+  R_xlen_t nb = (nbefore < n) ? (R_xlen_t) nbefore : n, na = (nafter < n) ? (R_xlen_t) nafter : n;
+  std::vector<ptrdiff_t> left(n), right(n);
+  rolling_window_bounds_capped(times.begin(), &n, left.data(), right.data(), &widthbefore, &widthafter, &nb, &na);
+  window_index_init(index, left.data(), right.data(), &n);
+}
+
+// Whether observation counts limit the rolling windows, see capped_window_index
+static bool counts_limited(double nbefore, double nafter) {
+  return nbefore != R_PosInf || nafter != R_PosInf;
+}
+
+// Apply a rolling kernel, optionally splitting the output range across threads, or its window index kernel
+// sequentially to the windows limited by observation counts
+static Rcpp::NumericVector rolling_apply(rolling_kernel kernel,
+                                         rolling_window_kernel window_kernel,
+                                         Rcpp::DatetimeVector times,
+                                         Rcpp::NumericVector values,
+                                         double widthbefore,
+                                         double widthafter,
+                                         int threads,
+                                         int grain,
+                                         double nbefore,
+                                         double nafter) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  R_xlen_t n = times.size();
+  Rcpp::NumericVector res(n);
+  if (counts_limited(nbefore, nafter)) {
+    window_index index;
+    capped_window_index(&index, times, widthbefore, widthafter, nbefore, nafter);
+    window_kernel(values.begin(), &index, res.begin());
+    window_index_free(&index);
+  } else if (threads > 1)
+    rolling_apply_parallel(kernel, values.begin(), times.begin(), &n, res.begin(),
+                           &widthbefore, &widthafter, &grain, &threads);
+  else
+    kernel(values.begin(), times.begin(), &n, res.begin(), &widthbefore, &widthafter);
+  return res;
+}
+
+// Apply a rolling kernel to each column of a matrix
+static Rcpp::NumericMatrix rolling_apply_matrix(rolling_matrix_kernel kernel,
+                                                Rcpp::DatetimeVector times,
+                                                Rcpp::NumericMatrix values,
+                                                double widthbefore,
+                                                double widthafter) {
+  if (times.size() != values.nrow()) Rcpp::stop("Matching rows needed.");
+  R_xlen_t n = values.nrow();
+  int ncol = values.ncol();
+  Rcpp::NumericMatrix res(n, ncol);
+  kernel(values.begin(), times.begin(), &n, &ncol, res.begin(), &widthbefore, &widthafter);
+  res.attr("dimnames") = values.attr("dimnames");
+  return res;
+}
+
+// Apply a rolling kernel of two time series, with the output at the observation times of the first
+static Rcpp::NumericVector rolling_apply_pair(rolling_pair_kernel kernel,
+                                              Rcpp::DatetimeVector timesx,
+                                              Rcpp::NumericVector valuesx,
+                                              Rcpp::DatetimeVector timesy,
+                                              Rcpp::NumericVector valuesy,
+                                              double widthbefore,
+                                              double widthafter) {
+  if (timesx.size() != valuesx.size() || timesy.size() != valuesy.size())
+    Rcpp::stop("Matching vectors needed.");
+  R_xlen_t nx = timesx.size(), ny = timesy.size();
+  Rcpp::NumericVector res(nx);
+  kernel(valuesx.begin(), timesx.begin(), &nx, valuesy.begin(), timesy.begin(), &ny, res.begin(),
+         &widthbefore, &widthafter);
+  return res;
+}
+
 //' The UTS library by Andreas Eckner provides algorithms for unevenly
 //' spaced time-series data.  This package brings a few of them to R.
 //' The functions describe here offer various rolling operators.
+//' Skewness and excess kurtosis are the moment estimators based on
+//' the central moments of the observations in the window.
+//' \code{rollingLogProduct} returns the logarithm of the absolute value
+//' of the rolling product, e.g. the log return over the window for gross
+//' returns, which stays finite where the product itself would overflow or
+//' underflow. \code{rollingMax} and \code{rollingMin} skip \code{NaN}
+//' values, and return \code{-Inf} and \code{Inf} for windows without
+//' other values. \code{rollingMedian} skips them as well, and returns
+//' \code{NaN} for such windows.
+//'
+//' As for \code{\link{rollingSummary}}, the rolling window can also be
+//' limited to the observations at positions \code{i - nbefore} to
+//' \code{i + nafter} of its time window, e.g. to the last \code{k}
+//' observations for infinite widths, \code{nbefore = k - 1} and
+//' \code{nafter = 0}. Such windows are determined once up front, and the
+//' statistics then updated incrementally as for time windows, without
+//' splitting the series across threads.
 //' @title Rolling operations functions for irregularly spaced time series
 //' @param times A Datetime vector
 //' @param values A numeric vector
 //' @param widthbefore A double with the preceding observation width
 //' @param widthafter A double with the subsequent observation width
 //' @param moment A double with the requested moment.
+//' @param threads An integer with the number of threads; values above one
+//' split the series into chunks which are processed in parallel.
+//' @param grain An integer with the number of observations per chunk, or
+//' zero for four chunks per thread. Each chunk also processes the
+//' observations within one window width of its boundaries, so the grain
+//' should be large relative to the number of observations per window.
+//' @param nbefore A double with the maximum number of preceding
+//' observations in the rolling window, by default unlimited
+//' @param nafter A double with the maximum number of subsequent
+//' observations in the rolling window, by default unlimited
 //' @return A numeric vector with the corresponding result.
 //' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
 //' underlying code.
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingCentralMoment(Rcpp::DatetimeVector times,
                                          Rcpp::NumericVector values,
-                                         const double widthbefore,
-                                         const double widthafter,
-                                         const double moment) {
+                                         const TimeWidth widthbefore,
+                                         const TimeWidth widthafter,
+                                         const double moment,
+                                         const double nbefore = R_PosInf,
+                                         const double nafter = R_PosInf) {
   if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
+  R_xlen_t n = times.size();
   Rcpp::NumericVector res(n);
+  if (counts_limited(nbefore, nafter)) {
+    window_index index;
+    capped_window_index(&index, times, widthbefore, widthafter, nbefore, nafter);
+    rolling_central_moment_window(values.begin(), &index, res.begin(), const_cast<double*>(&moment));
+    window_index_free(&index);
+    return res;
+  }
   rolling_central_moment(values.begin(), times.begin(), &n, res.begin(),
-                         const_cast<double*>(&widthbefore),
-                         const_cast<double*>(&widthafter),
+                         widthbefore.ptr(),
+                         widthafter.ptr(),
                          const_cast<double*>(&moment));
   return res;
 }
 
+//' @rdname rollingCentralMoment
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingKurtosis(Rcpp::DatetimeVector times,
+                                    Rcpp::NumericVector values,
+                                    const TimeWidth widthbefore,
+                                    const TimeWidth widthafter,
+                                    int threads = 1,
+                                    int grain = 0,
+                                    const double nbefore = R_PosInf,
+                                    const double nafter = R_PosInf) {
+  return rolling_apply(rolling_kurtosis, rolling_kurtosis_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
+}
+
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingMax(Rcpp::DatetimeVector times,
                                Rcpp::NumericVector values,
-                               const double widthbefore,
-                               const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_max(values.begin(), times.begin(), &n, res.begin(),
-              const_cast<double*>(&widthbefore),
-              const_cast<double*>(&widthafter));
-  return res;
+                               const TimeWidth widthbefore,
+                               const TimeWidth widthafter,
+                               int threads = 1,
+                               int grain = 0,
+                               const double nbefore = R_PosInf,
+                               const double nafter = R_PosInf) {
+  return rolling_apply(rolling_max, rolling_max_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingMean(Rcpp::DatetimeVector times,
                                 Rcpp::NumericVector values,
-                                const double widthbefore,
-                                const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_mean(values.begin(), times.begin(), &n, res.begin(),
-               const_cast<double*>(&widthbefore),
-               const_cast<double*>(&widthafter));
-  return res;
+                                const TimeWidth widthbefore,
+                                const TimeWidth widthafter,
+                                int threads = 1,
+                                int grain = 0,
+                                const double nbefore = R_PosInf,
+                                const double nafter = R_PosInf) {
+  return rolling_apply(rolling_mean, rolling_mean_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingMedian(Rcpp::DatetimeVector times,
                                   Rcpp::NumericVector values,
-                                  const double widthbefore,
-                                  const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_median(values.begin(), times.begin(), &n, res.begin(),
-                 const_cast<double*>(&widthbefore),
-                 const_cast<double*>(&widthafter));
-  return res;
+                                  const TimeWidth widthbefore,
+                                  const TimeWidth widthafter,
+                                  int threads = 1,
+                                  int grain = 0,
+                                  const double nbefore = R_PosInf,
+                                  const double nafter = R_PosInf) {
+  return rolling_apply(rolling_median, rolling_median_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
         
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingMin(Rcpp::DatetimeVector times,
                                Rcpp::NumericVector values,
-                               const double widthbefore,
-                               const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_min(values.begin(), times.begin(), &n, res.begin(),
-              const_cast<double*>(&widthbefore),
-              const_cast<double*>(&widthafter));
-  return res;
+                               const TimeWidth widthbefore,
+                               const TimeWidth widthafter,
+                               int threads = 1,
+                               int grain = 0,
+                               const double nbefore = R_PosInf,
+                               const double nafter = R_PosInf) {
+  return rolling_apply(rolling_min, rolling_min_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingNobs(Rcpp::DatetimeVector times,
                                 Rcpp::NumericVector values,
-                                const double widthbefore,
-                                const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_num_obs(values.begin(), times.begin(), &n, res.begin(),
-                  const_cast<double*>(&widthbefore),
-                  const_cast<double*>(&widthafter));
-  return res;
+                                const TimeWidth widthbefore,
+                                const TimeWidth widthafter,
+                                int threads = 1,
+                                int grain = 0,
+                                const double nbefore = R_PosInf,
+                                const double nafter = R_PosInf) {
+  return rolling_apply(rolling_num_obs, rolling_num_obs_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingProduct(Rcpp::DatetimeVector times,
                                    Rcpp::NumericVector values,
-                                   const double widthbefore,
-                                   const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_product(values.begin(), times.begin(), &n, res.begin(),
-                  const_cast<double*>(&widthbefore),
-                  const_cast<double*>(&widthafter));
-  return res;
+                                   const TimeWidth widthbefore,
+                                   const TimeWidth widthafter,
+                                   int threads = 1,
+                                   int grain = 0,
+                                   const double nbefore = R_PosInf,
+                                   const double nafter = R_PosInf) {
+  return rolling_apply(rolling_product, rolling_product_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
+}
+
+//' @rdname rollingCentralMoment
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingLogProduct(Rcpp::DatetimeVector times,
+                                      Rcpp::NumericVector values,
+                                      const TimeWidth widthbefore,
+                                      const TimeWidth widthafter,
+                                      int threads = 1,
+                                      int grain = 0,
+                                      const double nbefore = R_PosInf,
+                                      const double nafter = R_PosInf) {
+  return rolling_apply(rolling_log_product, rolling_log_product_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingSD(Rcpp::DatetimeVector times,
                               Rcpp::NumericVector values,
-                              const double widthbefore,
-                              const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_sd(values.begin(), times.begin(), &n, res.begin(),
-             const_cast<double*>(&widthbefore),
-             const_cast<double*>(&widthafter));
-  return res;
+                              const TimeWidth widthbefore,
+                              const TimeWidth widthafter,
+                              int threads = 1,
+                              int grain = 0,
+                              const double nbefore = R_PosInf,
+                              const double nafter = R_PosInf) {
+  return rolling_apply(rolling_sd, rolling_sd_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
+}
+
+//' @rdname rollingCentralMoment
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingSkewness(Rcpp::DatetimeVector times,
+                                    Rcpp::NumericVector values,
+                                    const TimeWidth widthbefore,
+                                    const TimeWidth widthafter,
+                                    int threads = 1,
+                                    int grain = 0,
+                                    const double nbefore = R_PosInf,
+                                    const double nafter = R_PosInf) {
+  return rolling_apply(rolling_skewness, rolling_skewness_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingSum(Rcpp::DatetimeVector times,
                                Rcpp::NumericVector values,
-                               const double widthbefore,
-                               const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_sum(values.begin(), times.begin(), &n, res.begin(),
-              const_cast<double*>(&widthbefore),
-              const_cast<double*>(&widthafter));
-  return res;
+                               const TimeWidth widthbefore,
+                               const TimeWidth widthafter,
+                               int threads = 1,
+                               int grain = 0,
+                               const double nbefore = R_PosInf,
+                               const double nafter = R_PosInf) {
+  return rolling_apply(rolling_sum, rolling_sum_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingSumStable(Rcpp::DatetimeVector times,
                                      Rcpp::NumericVector values,
-                                     const double widthbefore,
-                                     const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_sum_stable(values.begin(), times.begin(), &n, res.begin(),
-                     const_cast<double*>(&widthbefore),
-                     const_cast<double*>(&widthafter));
-  return res;
+                                     const TimeWidth widthbefore,
+                                     const TimeWidth widthafter,
+                                     int threads = 1,
+                                     int grain = 0,
+                                     const double nbefore = R_PosInf,
+                                     const double nafter = R_PosInf) {
+  return rolling_apply(rolling_sum_stable, rolling_sum_stable_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
 }
 
 //' @rdname rollingCentralMoment
 // [[Rcpp::export]]
 Rcpp::NumericVector rollingVar(Rcpp::DatetimeVector times,
                                Rcpp::NumericVector values,
-                               const double widthbefore,
-                               const double widthafter) {
+                               const TimeWidth widthbefore,
+                               const TimeWidth widthafter,
+                               int threads = 1,
+                               int grain = 0,
+                               const double nbefore = R_PosInf,
+                               const double nafter = R_PosInf) {
+  return rolling_apply(rolling_var, rolling_var_window, times, values, widthbefore, widthafter,
+                       threads, grain, nbefore, nafter);
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here apply rolling operators to each column
+//' of a matrix of time series sharing the same observation times. The
+//' rolling windows are determined only once for all columns, and blocks
+//' of columns are then processed together.
+//'
+//' \code{rollingMatrix} applies any of the single-statistic rolling
+//' operations to each column, over a window index of the shared
+//' observation times. The results equal those of the corresponding
+//' rolling function, e.g. \code{\link{rollingMedian}}, for each column.
+//' @title Rolling operations for panels of irregularly spaced time series
+//' @param times A Datetime vector
+//' @param values A numeric matrix with one row per observation time
+//' @param widthbefore A double with the preceding observation width
+//' @param widthafter A double with the subsequent observation width
+//' @return A numeric matrix with the result for each column of \code{values}.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingMean}}, \code{\link{SMAnext}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingMeanMatrix(Rcpp::DatetimeVector times,
+                                      Rcpp::NumericMatrix values,
+                                      const TimeWidth widthbefore,
+                                      const TimeWidth widthafter) {
+  return rolling_apply_matrix(rolling_mean_matrix, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMatrix
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingSumMatrix(Rcpp::DatetimeVector times,
+                                     Rcpp::NumericMatrix values,
+                                     const TimeWidth widthbefore,
+                                     const TimeWidth widthafter) {
+  return rolling_apply_matrix(rolling_sum_matrix, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMatrix
+//' @param stat A character string with the rolling operation, one of
+//' \code{"kurtosis"}, \code{"max"}, \code{"mean"}, \code{"median"},
+//' \code{"min"}, \code{"nobs"}, \code{"product"}, \code{"logproduct"},
+//' \code{"sd"}, \code{"skewness"}, \code{"sum"}, \code{"sumstable"} or
+//' \code{"var"}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingMatrix(Rcpp::DatetimeVector times,
+                                  Rcpp::NumericMatrix values,
+                                  const TimeWidth widthbefore,
+                                  const TimeWidth widthafter,
+                                  const std::string stat = "mean") {
+  if (stat == "mean") return rolling_apply_matrix(rolling_mean_matrix, times, values, widthbefore, widthafter);
+  if (stat == "sum") return rolling_apply_matrix(rolling_sum_matrix, times, values, widthbefore, widthafter);
+  rolling_window_kernel kernel = rolling_window_kernel_named(stat);
+  if (times.size() != values.nrow()) Rcpp::stop("Matching rows needed.");
+  R_xlen_t n = values.nrow();
+  Rcpp::NumericMatrix res(n, values.ncol());
+  window_index index;
+  capped_window_index(&index, times, widthbefore, widthafter, R_PosInf, R_PosInf);
+  for (int col = 0; col < values.ncol(); col++)
+    kernel(values.begin() + col * n, &index, res.begin() + col * n);
+  window_index_free(&index);
+  res.attr("dimnames") = values.attr("dimnames");
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here apply a rolling operator for several
+//' window widths, or EMA half-lives, to the same time series. All windows
+//' are advanced together in a single pass over the observations, and the
+//' results equal those of separate calls for each window.
+//' @title Rolling operations for several windows of irregularly spaced time series
+//' @param times A Datetime vector
+//' @param values A numeric vector
+//' @param widthbefore A numeric vector with the preceding observation widths
+//' @param widthafter A numeric vector with the subsequent observation widths;
+//' either of the two width vectors can also have length one, in which case
+//' it is recycled
+//' @return A numeric matrix with one row per observation time, and one
+//' column per window width.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingMean}}, \code{\link{SMAnext}},
+//' \code{\link{EMAnext}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingMeanMulti(Rcpp::DatetimeVector times,
+                                     Rcpp::NumericVector values,
+                                     Rcpp::NumericVector widthbefore,
+                                     Rcpp::NumericVector widthafter) {
+  return rolling_apply_multi(rolling_mean_multi, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMulti
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingSDMulti(Rcpp::DatetimeVector times,
+                                   Rcpp::NumericVector values,
+                                   Rcpp::NumericVector widthbefore,
+                                   Rcpp::NumericVector widthafter) {
+  return rolling_apply_multi(rolling_sd_multi, times, values, widthbefore, widthafter);
+}
+
+// Apply the fused rolling summary kernel at the given output times, with one named column per requested statistic
+template <class Time>
+static Rcpp::NumericMatrix rolling_summary_apply(Time *times,
+                                                 Rcpp::NumericVector values,
+                                                 Time *at,
+                                                 R_xlen_t m,
+                                                 Time widthbefore,
+                                                 Time widthafter,
+                                                 Rcpp::CharacterVector stats,
+                                                 ptrdiff_t *nbefore,
+                                                 ptrdiff_t *nafter) {
+  R_xlen_t n = values.size();
+  int mask = summary_stats_named(stats);
+  Rcpp::NumericMatrix res = summary_matrix(m, mask);
+  rolling_summary_dispatch<SUMMARY_ALL>::run(mask, values.begin(), &n, &m, res.begin(),
+                                             time_windows<Time>(times, at, &widthbefore, &widthafter, nbefore, nafter));
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The function describe here calculates several rolling statistics of
+//' the same rolling window in a single pass over the observations, each
+//' equal to the result of the corresponding rolling function.
+//'
+//' The rolling window can also be limited by the number of observations:
+//' the window at the \code{i}-th observation then consists of the
+//' observations in its time window at positions \code{i - nbefore} to
+//' \code{i + nafter}. With infinite widths this gives a count-based window,
+//' e.g. the last \code{k} observations for \code{nbefore = k - 1} and
+//' \code{nafter = 0}, and with finite widths a hybrid window that is the
+//' smaller of the two. All statistics are still updated incrementally in a
+//' single pass.
+//' @title Rolling summary statistics for irregularly spaced time series
+//' @param times A Datetime vector, or a nanotime or integer64 vector with
+//' integer times, e.g. nanoseconds, for which the rolling windows are
+//' determined exactly in integer arithmetic
+//' @param values A numeric vector
+//' @param widthbefore A double, or an integer64 value such as a
+//' nanoduration, with the preceding observation width, in the unit of the
+//' times (i.e. whole nanoseconds for nanotime)
+//' @param widthafter A double with the subsequent observation width
+//' @param stats A character vector with the requested statistics, any of
+//' \code{"nobs"}, \code{"sum"}, \code{"mean"}, \code{"var"}, \code{"min"}
+//' and \code{"max"}.
+//' @param nbefore A double with the maximum number of preceding
+//' observations in the rolling window, by default unlimited
+//' @param nafter A double with the maximum number of subsequent
+//' observations in the rolling window, by default unlimited
+//' @return A numeric matrix with one row per observation time, and one
+//' named column per requested statistic, in the order given above.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingCentralMoment}}, \code{\link{EMAat}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingSummary(SEXP times,
+                                   Rcpp::NumericVector values,
+                                   const TimeWidth widthbefore,
+                                   const TimeWidth widthafter,
+                                   Rcpp::CharacterVector stats = Rcpp::CharacterVector::create("nobs", "sum", "mean", "var", "min", "max"),
+                                   const double nbefore = R_PosInf,
+                                   const double nafter = R_PosInf) {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (!(nbefore >= 0) || !(nafter >= 0)) Rcpp::stop("Non-negative observation counts needed.");
+  R_xlen_t n = values.size();
+  R_xlen_t nb = (nbefore < n) ? (R_xlen_t) nbefore : n, na = (nafter < n) ? (R_xlen_t) nafter : n;
+  if (is_int64_times(times))
+    return rolling_summary_apply(int64_times(times), values, int64_times(times), n,
+                                 widthbefore.int64(), widthafter.int64(), stats, &nb, &na);
+  Rcpp::DatetimeVector t(times);
+  return rolling_summary_apply<double>(t.begin(), values, t.begin(), n, widthbefore, widthafter, stats, &nb, &na);
+}
+
+//' @rdname rollingSummary
+//' @param at A vector with non-decreasing output times, of the same class
+//' as \code{times}
+//' @details \code{rollingSummaryAt} calculates the statistics at the
+//' times in \code{at} instead of the observation times, using the
+//' observations in the rolling window around each of them, e.g. on a
+//' regular time grid or at the observation times of another series. The
+//' output times are merged with the observation times in a single pass.
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingSummaryAt(SEXP times,
+                                     Rcpp::NumericVector values,
+                                     SEXP at,
+                                     const TimeWidth widthbefore,
+                                     const TimeWidth widthafter,
+                                     Rcpp::CharacterVector stats = Rcpp::CharacterVector::create("nobs", "sum", "mean", "var", "min", "max")) {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (is_int64_times(times) != is_int64_times(at)) Rcpp::stop("Matching time classes needed.");
+  R_xlen_t m = XLENGTH(at);
+  if (is_int64_times(times)) {
+    int64_t *a = int64_times(at);
+    if (!std::is_sorted(a, a + m)) Rcpp::stop("Non-decreasing output times needed.");
+    return rolling_summary_apply(int64_times(times), values, a, m, widthbefore.int64(), widthafter.int64(),
+                                 stats, NULL, NULL);
+  }
+  Rcpp::DatetimeVector t(times), a(at);
+  if (!std::is_sorted(a.begin(), a.end())) Rcpp::stop("Non-decreasing output times needed.");
+  return rolling_summary_apply<double>(t.begin(), values, a.begin(), m, widthbefore, widthafter, stats, NULL, NULL);
+}
+
+// Window index of the time windows at the output times 'at', over the observations at 'times'
+static void at_window_index(window_index *index,
+                            SEXP times,
+                            SEXP at,
+                            const TimeWidth &widthbefore,
+                            const TimeWidth &widthafter) {
+  if (is_int64_times(times) != is_int64_times(at)) Rcpp::stop("Matching time classes needed.");
+  R_xlen_t n = XLENGTH(times), m = XLENGTH(at);
+  std::vector<ptrdiff_t> left(m), right(m);
+  if (is_int64_times(times)) {
+    int64_t *a = int64_times(at), wb = widthbefore.int64(), wa = widthafter.int64();
+    if (!std::is_sorted(a, a + m)) Rcpp::stop("Non-decreasing output times needed.");
+    window_bounds(time_windows<int64_t>(int64_times(times), a, &wb, &wa), &n, &m, left.data(), right.data());
+  } else {
+    Rcpp::DatetimeVector t(times), a(at);
+    if (!std::is_sorted(a.begin(), a.end())) Rcpp::stop("Non-decreasing output times needed.");
+    window_bounds(time_windows<double>(t.begin(), a.begin(), widthbefore.ptr(), widthafter.ptr()),
+                  &n, &m, left.data(), right.data());
+  }
+  window_index_init(index, left.data(), right.data(), &m);
+  index->num_obs = n;
+}
+
+//' @rdname rollingSummary
+//' @param stat A character string with the rolling operation of
+//' \code{rollingAt}, see \code{\link{rollingInto}}
+//' @details \code{rollingAt} and \code{rollingQuantileAt} calculate the
+//' other rolling operations, e.g. the median, product, standard deviation,
+//' skewness or kurtosis, and the rolling quantiles at the times in
+//' \code{at} in the same way. They use the same kernels as the functions
+//' at the observation times, such as \code{\link{rollingMedian}} and
+//' \code{\link{rollingQuantile}}, with the windows of the output times,
+//' and return a numeric vector, respectively a matrix with one column per
+//' probability. A window without observations gives the value of an
+//' empty window, e.g. \code{NaN} for the median, zero for \code{"nobs"}
+//' and \code{"sum"}, and \code{-Inf} for \code{"max"}.
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingAt(SEXP times,
+                              Rcpp::NumericVector values,
+                              SEXP at,
+                              const TimeWidth widthbefore,
+                              const TimeWidth widthafter,
+                              const std::string stat = "median") {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  rolling_window_kernel kernel = rolling_window_kernel_named(stat);
+  Rcpp::NumericVector res(XLENGTH(at));
+  window_index index;
+  at_window_index(&index, times, at, widthbefore, widthafter);
+  kernel(values.begin(), &index, res.begin());
+  window_index_free(&index);
+  return res;
+}
+
+//' @rdname rollingSummary
+//' @param probs A numeric vector with probabilities between zero and one
+//' @param type An integer between 1 and 9 selecting the quantile
+//' definition, as in \code{\link[stats]{quantile}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingQuantileAt(SEXP times,
+                                      Rcpp::NumericVector values,
+                                      SEXP at,
+                                      const TimeWidth widthbefore,
+                                      const TimeWidth widthafter,
+                                      Rcpp::NumericVector probs,
+                                      int type = 7) {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (type < 1 || type > 9) Rcpp::stop("Quantile type must be between 1 and 9.");
+  int k = probs.size();
+  Rcpp::NumericMatrix res(XLENGTH(at), k);
+  res.attr("dimnames") = Rcpp::List::create(R_NilValue, quantile_names(probs));
+  window_index index;
+  at_window_index(&index, times, at, widthbefore, widthafter);
+  rolling_quantile_window(values.begin(), &index, res.begin(), probs.begin(), &k, &type);
+  window_index_free(&index);
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here offer the rolling covariance, correlation
+//' and beta of two time series, which need not share their observation
+//' times.
+//'
+//' The second series is sampled at the observation times of the first
+//' one, using its most recent value at or before each time, and the
+//' rolling windows are those of the first series; observations before
+//' the first observation of the second series are left out. The beta is
+//' the slope of the first series on the second, i.e. the covariance
+//' divided by the variance of the second series. All results are
+//' calculated from incrementally updated sums in a single pass.
+//' @title Rolling co-moments of two irregularly spaced time series
+//' @param timesx A Datetime vector with the observation times of the first series
+//' @param valuesx A numeric vector with the values of the first series
+//' @param timesy A Datetime vector with the observation times of the second series
+//' @param valuesy A numeric vector with the values of the second series
+//' @param widthbefore A double with the preceding observation width
+//' @param widthafter A double with the subsequent observation width
+//' @return A numeric vector with the result at the observation times of
+//' the first series.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingVar}}, \code{\link{EMAcov}}
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingCov(Rcpp::DatetimeVector timesx,
+                               Rcpp::NumericVector valuesx,
+                               Rcpp::DatetimeVector timesy,
+                               Rcpp::NumericVector valuesy,
+                               const TimeWidth widthbefore,
+                               const TimeWidth widthafter) {
+  return rolling_apply_pair(rolling_cov, timesx, valuesx, timesy, valuesy, widthbefore, widthafter);
+}
+
+//' @rdname rollingCov
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingCor(Rcpp::DatetimeVector timesx,
+                               Rcpp::NumericVector valuesx,
+                               Rcpp::DatetimeVector timesy,
+                               Rcpp::NumericVector valuesy,
+                               const TimeWidth widthbefore,
+                               const TimeWidth widthafter) {
+  return rolling_apply_pair(rolling_cor, timesx, valuesx, timesy, valuesy, widthbefore, widthafter);
+}
+
+//' @rdname rollingCov
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingBeta(Rcpp::DatetimeVector timesx,
+                                Rcpp::NumericVector valuesx,
+                                Rcpp::DatetimeVector timesy,
+                                Rcpp::NumericVector valuesy,
+                                const TimeWidth widthbefore,
+                                const TimeWidth widthafter) {
+  return rolling_apply_pair(rolling_beta, timesx, valuesx, timesy, valuesy, widthbefore, widthafter);
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The function describe here calculates rolling quantiles for several
+//' probabilities, sharing one order-statistic tree of the window values
+//' between them, so that each window update costs logarithmic time in
+//' the number of observations of the window. \code{NaN} values are
+//' skipped, as for \code{na.rm = TRUE}, and a window without other values
+//' gives \code{NaN}.
+//' @title Rolling quantiles for irregularly spaced time series
+//' @param times A Datetime vector
+//' @param values A numeric vector
+//' @param widthbefore A double with the preceding observation width
+//' @param widthafter A double with the subsequent observation width
+//' @param probs A numeric vector with probabilities between zero and one
+//' @param type An integer between 1 and 9 selecting the quantile
+//' definition, as in \code{\link[stats]{quantile}}
+//' @param nbefore A double with the maximum number of preceding
+//' observations in the rolling window of \code{rollingQuantile}, by default
+//' unlimited, see \code{\link{rollingCentralMoment}}
+//' @param nafter A double with the maximum number of subsequent
+//' observations in the rolling window, by default unlimited
+//' @return A numeric matrix with one row per observation time, and one
+//' column per probability named as by \code{\link[stats]{quantile}}.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingMedian}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingQuantile(Rcpp::DatetimeVector times,
+                                    Rcpp::NumericVector values,
+                                    const TimeWidth widthbefore,
+                                    const TimeWidth widthafter,
+                                    Rcpp::NumericVector probs,
+                                    int type = 7,
+                                    const double nbefore = R_PosInf,
+                                    const double nafter = R_PosInf) {
   if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  rolling_var(values.begin(), times.begin(), &n, res.begin(),
-              const_cast<double*>(&widthbefore),
-              const_cast<double*>(&widthafter));
+  if (type < 1 || type > 9) Rcpp::stop("Quantile type must be between 1 and 9.");
+  R_xlen_t n = times.size();
+  int k = probs.size();
+  Rcpp::NumericMatrix res(n, k);
+  res.attr("dimnames") = Rcpp::List::create(R_NilValue, quantile_names(probs));
+  if (counts_limited(nbefore, nafter)) {
+    window_index index;
+    capped_window_index(&index, times, widthbefore, widthafter, nbefore, nafter);
+    rolling_quantile_window(values.begin(), &index, res.begin(), probs.begin(), &k, &type);
+    window_index_free(&index);
+    return res;
+  }
+  rolling_quantile(values.begin(), times.begin(), &n, res.begin(),
+                   widthbefore.ptr(), widthafter.ptr(),
+                   probs.begin(), &k, &type);
+  return res;
+}
+
+//' @rdname rollingQuantile
+//' @param compression A double with the accuracy parameter of the
+//' t-digests; larger values are more accurate but use more memory and time
+//' @param buckets An integer with the number of time buckets per window
+//' width
+//' @details \code{rollingQuantileApprox} summarizes the observations of
+//' each of \code{buckets} time buckets per window width by a t-digest
+//' (Dunning and Ertl, 2019), so that its memory does not grow with the
+//' number of observations in a window. The rolling window contains the
+//' same observations as for \code{rollingQuantile}, but the oldest bucket
+//' of a window, which usually lies only partly inside it, is represented
+//' by its digest with the weights scaled to the number of its observations
+//' still inside; this adds a rank error of at most about one over the
+//' number of buckets. As long as a window holds few observations relative
+//' to \code{compression}, the results equal those of \code{type = 5}.
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingQuantileApprox(Rcpp::DatetimeVector times,
+                                          Rcpp::NumericVector values,
+                                          const TimeWidth widthbefore,
+                                          const TimeWidth widthafter,
+                                          Rcpp::NumericVector probs,
+                                          double compression = 100,
+                                          int buckets = 32) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  if (buckets < 1) Rcpp::stop("At least one bucket needed.");
+  R_xlen_t n = times.size();
+  int k = probs.size();
+  Rcpp::NumericMatrix res(n, k);
+  res.attr("dimnames") = Rcpp::List::create(R_NilValue, quantile_names(probs));
+  rolling_quantile_approx(values.begin(), times.begin(), &n, res.begin(),
+                          widthbefore.ptr(), widthafter.ptr(),
+                          probs.begin(), &k, &compression, &buckets);
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The function describe here applies an associative operation to the
+//' observations of each rolling window, using a two-stack sliding-window
+//' aggregation with amortized constant cost per observation, also for
+//' operations without an inverse such as the minimum or the product of
+//' values that may be zero.
+//'
+//' Further operations can be added in C++ by defining a monoid type and
+//' calling the \code{rolling_aggregate} template of the header
+//' \code{RcppUTS/sliding_window.h}, e.g. via \code{LinkingTo: RcppUTS}.
+//' @title Rolling aggregation for irregularly spaced time series
+//' @param times A Datetime vector, or a nanotime or integer64 vector with
+//' integer times, e.g. nanoseconds, for which the rolling windows are
+//' determined exactly in integer arithmetic
+//' @param values A numeric vector
+//' @param widthbefore A double, or an integer64 value such as a
+//' nanoduration, with the preceding observation width, in the unit of the
+//' times (i.e. whole nanoseconds for nanotime)
+//' @param widthafter A double with the subsequent observation width
+//' @param op A character string with the operation, one of \code{"sum"},
+//' \code{"prod"}, \code{"min"}, \code{"max"}, \code{"any"} or \code{"all"};
+//' the latter two treat non-zero values as true.
+//' @return A numeric vector with the aggregate of each rolling window, or
+//' the identity of the operation for an empty window.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingMax}}, \code{\link{rollingProduct}}
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingAggregate(SEXP times,
+                                     Rcpp::NumericVector values,
+                                     TimeWidth widthbefore,
+                                     TimeWidth widthafter,
+                                     const std::string op = "sum") {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  Rcpp::NumericVector res(values.size());
+  if (is_int64_times(times)) {
+    int64_t wb = widthbefore.int64(), wa = widthafter.int64();
+    rolling_aggregate_named(op, values.begin(), values.size(), res.begin(),
+                            time_windows<int64_t>(int64_times(times), int64_times(times), &wb, &wa));
+  } else {
+    Rcpp::DatetimeVector t(times);
+    rolling_aggregate_named(op, values.begin(), values.size(), res.begin(),
+                            time_windows<double>(t.begin(), t.begin(), widthbefore.ptr(), widthafter.ptr()));
+  }
   return res;
 }
+
+//' @rdname EMAinto
+//' @param stat A character string with the rolling operation, one of
+//' \code{"kurtosis"}, \code{"max"}, \code{"mean"}, \code{"median"},
+//' \code{"min"}, \code{"nobs"}, \code{"product"}, \code{"logproduct"},
+//' \code{"sd"}, \code{"skewness"}, \code{"sum"}, \code{"sumstable"} or
+//' \code{"var"}, as computed by the corresponding function such as
+//' \code{\link{rollingMean}}
+// [[Rcpp::export]]
+SEXP rollingInto(SEXP times,
+                 SEXP values,
+                 SEXP out,
+                 TimeWidth widthbefore,
+                 TimeWidth widthafter,
+                 const std::string stat = "mean",
+                 int threads = 1,
+                 int grain = 0) {
+  Rcpp::NumericVector t = double_buffer(times, "times"), v = double_buffer(values, "values"),
+    res = double_buffer(out, "out");
+  check_buffers(t, v, res);
+  rolling_kernel kernel = rolling_kernel_named(stat);
+  R_xlen_t n = t.size();
+  if (threads > 1)
+    rolling_apply_parallel(kernel, v.begin(), t.begin(), &n, res.begin(),
+                           widthbefore.ptr(), widthafter.ptr(), &grain, &threads);
+  else
+    kernel(v.begin(), t.begin(), &n, res.begin(), widthbefore.ptr(), widthafter.ptr());
+  return out;
+}
@@ -0,0 +1,173 @@
+// Fused rolling summary statistics
+// -) a single pass over the observations maintains the accumulators of all requested statistics in the same
+//    rolling window, instead of one pass per statistic
+// -) the statistics are selected by the template argument, so that the code for unused statistics is removed
+//    at compile time; rolling_summary_dispatch selects the instantiation for a run-time selection
+// -) each statistic equals the result of the corresponding rolling_* kernel
+// -) the rolling window can be further limited by the number of observations before and after t_i, as in
+//    rolling_window_bounds_capped; the accumulators are updated incrementally in either case
+// -) the statistics can also be calculated at arbitrary non-decreasing query times instead of the observation
+//    times, with the rolling window (t - width_before, t + width_after] of each query time t; the query times are
+//    merged with the observation times, so that the run time is O(n + m)
+// -) the observation times can be doubles or 64-bit integers such as nanoseconds since the epoch, in which case
+//    the rolling windows are determined with exact integer arithmetic, see <RcppUTS/time_window.h>
+// -) rolling_summary_windows takes the rolling windows as an object instead, e.g. the precomputed windows of a
+//    window index, which are then not searched in the observation times again
+
+#ifndef _rolling_summary_h
+#define _rolling_summary_h
+
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+
+extern "C" {
+#include "rolling.h"
+}
+
+#include <RcppUTS/time_window.h>
+
+// Statistics calculated by rolling_summary, in the order of the output columns
+#define SUMMARY_NOBS 1
+#define SUMMARY_SUM  2
+#define SUMMARY_MEAN 4
+#define SUMMARY_VAR  8
+#define SUMMARY_MIN  16
+#define SUMMARY_MAX  32
+#define SUMMARY_ALL  63
+
+
+template <int Stats, class Windows>
+void rolling_summary_windows(double values[], ptrdiff_t *n, ptrdiff_t *n_new, double values_new[], const Windows &windows)
+{
+  // values     ... array of time series values
+  // n          ... number of observations, i.e. length of 'values'
+  // n_new      ... number of output times
+  // values_new ... column-major matrix with *n_new rows and one column for each statistic in 'Stats'
+  // windows    ... rolling windows of the output times, e.g. time_windows, see <RcppUTS/time_window.h>
+
+  const bool need_sum = (Stats & (SUMMARY_SUM | SUMMARY_MEAN)) != 0;
+  ptrdiff_t left = 0, right = -1, rebase_pos = -1, count;
+  ptrdiff_t min_head = 0, min_tail = 0, max_head = 0, max_tail = 0;
+  double roll_sum = 0, m2, m3, m4, *out;
+  moment_sums ms;
+
+  // Positions of candidates for the minimum and maximum, as in rolling_min and rolling_max
+  std::vector<ptrdiff_t> min_deque((Stats & SUMMARY_MIN) ? *n : 0), max_deque((Stats & SUMMARY_MAX) ? *n : 0);
+
+  moment_sums_reset(&ms, 0);
+
+  for (ptrdiff_t i = 0; i < *n_new; i++) {
+    // Expand window on the right
+    while ((right < *n - 1) && windows.includes_right(right + 1, i)) {
+      right++;
+      if (need_sum)
+        roll_sum = roll_sum + values[right];
+      if (Stats & SUMMARY_VAR)
+        moment_sums_update(&ms, values[right], 1);
+      if (Stats & SUMMARY_MIN) {
+        while ((min_tail > min_head) && (values[right] <= values[min_deque[min_tail - 1]]))
+          min_tail--;
+        min_deque[min_tail++] = right;
+      }
+      if (Stats & SUMMARY_MAX) {
+        while ((max_tail > max_head) && (values[right] >= values[max_deque[max_tail - 1]]))
+          max_tail--;
+        max_deque[max_tail++] = right;
+      }
+    }
+
+    // Shrink window on the left, but not past its right end, which a count limit can hold back, see
+    // rolling_window_bounds_capped; only observations added on the right are removed
+    while ((left <= right) && windows.excludes_left(left, i)) {
+      if (need_sum)
+        roll_sum = roll_sum - values[left];
+      if (Stats & SUMMARY_VAR)
+        moment_sums_update(&ms, values[left], -1);
+      left++;
+    }
+    count = right - left + 1;
+
+    // Save statistics for current time window
+    out = values_new + i;
+    if (Stats & SUMMARY_NOBS) {
+      *out = count;
+      out += *n_new;
+    }
+    if (Stats & SUMMARY_SUM) {
+      *out = roll_sum;
+      out += *n_new;
+    }
+    if (Stats & SUMMARY_MEAN) {
+      *out = (count > 0) ? roll_sum / count : NAN;
+      out += *n_new;
+    }
+    if (Stats & SUMMARY_VAR) {
+      if (left > rebase_pos) {
+        moment_sums_rebase(&ms, values, left, right);
+        rebase_pos = right;
+      }
+      if (count < 2)
+        *out = NAN;
+      else {
+        moment_sums_central(&ms, count, &m2, &m3, &m4);
+        *out = m2 / (count - 1);
+      }
+      out += *n_new;
+    }
+    if (Stats & SUMMARY_MIN) {
+      while ((min_head < min_tail) && (min_deque[min_head] < left))
+        min_head++;
+      *out = (min_head < min_tail) ? values[min_deque[min_head]] : INFINITY;
+      out += *n_new;
+    }
+    if (Stats & SUMMARY_MAX) {
+      while ((max_head < max_tail) && (max_deque[max_head] < left))
+        max_head++;
+      *out = (max_head < max_tail) ? values[max_deque[max_head]] : -INFINITY;
+    }
+  }
+}
+
+
+template <int Stats, class Time>
+void rolling_summary(double values[], Time times[], ptrdiff_t *n, Time times_new[], ptrdiff_t *n_new, double values_new[],
+  Time *width_before, Time *width_after, ptrdiff_t *n_before, ptrdiff_t *n_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // times_new    ... array of non-decreasing output times, e.g. 'times' itself
+  // n_new        ... number of output times, i.e. length of 'times_new'
+  // values_new   ... column-major matrix with *n_new rows and one column for each statistic in 'Stats'
+  // width_before ... (non-negative) width of rolling window before the i-th output time
+  // width_after  ... (non-negative) width of rolling window after the i-th output time
+  // n_before     ... (non-negative) maximum number of observations before position i in the window, or NULL
+  // n_after      ... (non-negative) maximum number of observations after position i in the window, or NULL
+  //                  (count limits require 'times_new' to be 'times')
+
+  rolling_summary_windows<Stats>(values, n, n_new, values_new,
+    time_windows<Time>(times, times_new, width_before, width_after, n_before, n_after));
+}
+
+
+// Call rolling_summary_windows<stats> for a run-time value of 'stats' between 1 and Stats
+template <int Stats>
+struct rolling_summary_dispatch {
+  template <class Windows>
+  static void run(int stats, double values[], ptrdiff_t *n, ptrdiff_t *n_new, double values_new[], const Windows &windows)
+  {
+    if (stats == Stats)
+      rolling_summary_windows<Stats>(values, n, n_new, values_new, windows);
+    else
+      rolling_summary_dispatch<Stats - 1>::run(stats, values, n, n_new, values_new, windows);
+  }
+};
+
+template <>
+struct rolling_summary_dispatch<0> {
+  template <class Windows>
+  static void run(int, double[], ptrdiff_t *, ptrdiff_t *, double[], const Windows &) {}
+};
+
+#endif
@@ -1,6 +1,8 @@
 // Copyright: 2012-2017 by Andreas Eckner
 // License: GPL-2 | GPL-3
 
+#include <math.h>
+#include <stdlib.h>
 #include "sma.h"
 
 #ifndef MAX
@@ -11,10 +13,18 @@
 #  define MIN(a,b) (((a) < (b)) ? (a) : (b))
 #endif
 
+// Interpolation of observation values between observation times
+#define SMA_LAST   0
+#define SMA_NEXT   1
+#define SMA_LINEAR 2
+
+// Number of matrix columns processed together by the *_matrix functions, see MATRIX_BLOCK in rolling.c
+#define MATRIX_BLOCK 8
+
 
 // Calculate the area of the trapezoid with corner coordinates (x2, 0), (x2, y2), (x3, 0), (x3, y3),
 // where y2 is obtained by linear interpolation of (x1, y1) and (x3, y3) evaluated at x2.
-static inline double trapezoid_left(double x1, double x2, double x3, double y1, double y3)
+double trapezoid_left(double x1, double x2, double x3, double y1, double y3)
 {
   // Degenerate cases
   if ((x2 == x3) || (x2 < x1))
@@ -29,7 +39,7 @@ static inline double trapezoid_left(double x1, double x2, double x3, double y1,
 
 // Calculate the area of the trapezoid with corner coordinates (x1, 0), (x1, y1), (x2, 0), (x2, y2),
 // where y2 is obtained by linear interpolation of (x1, y1) and (x3, y3) evaluated at x2.
-static inline double trapezoid_right(double x1, double x2, double x3, double y1, double y3)
+double trapezoid_right(double x1, double x2, double x3, double y1, double y3)
 {
   // Degenerate cases
   if ((x2 == x1) || (x2 > x3))
@@ -43,7 +53,7 @@ static inline double trapezoid_right(double x1, double x2, double x3, double y1,
 
 
 // SMA_last(X, width)
-void sma_last(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after)
+void sma_last(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after)
 {
   // values       ... array of time series values
   // times        ... array of observation times
@@ -52,7 +62,7 @@ void sma_last(double values[], double times[], int *n, double values_new[], doub
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = 0;
+  ptrdiff_t left = 0, right = 0;
   double t_left_new, t_right_new, roll_area, left_area, right_area = 0;
   
   // Trivial case
@@ -64,7 +74,7 @@ void sma_last(double values[], double times[], int *n, double values_new[], doub
   roll_area = left_area = values[0] * (*width_before + *width_after);
   
   // Apply rolling window
-  for (int i = 1; i < *n; i++) {
+  for (ptrdiff_t i = 1; i < *n; i++) {
     // Remove truncated area on left and right end
     roll_area -= (left_area + right_area);
     
@@ -94,7 +104,7 @@ void sma_last(double values[], double times[], int *n, double values_new[], doub
 
 
 // SMA_next(X, width)
-void sma_next(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after)
+void sma_next(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after)
 {
   // values     ... array of time series values
   // times      ... array of observation times
@@ -103,7 +113,7 @@ void sma_next(double values[], double times[], int *n, double values_new[], doub
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = 0;
+  ptrdiff_t left = 0, right = 0;
   double t_left_new, t_right_new, roll_area, left_area, right_area = 0;
   
   // Trivial case
@@ -115,7 +125,7 @@ void sma_next(double values[], double times[], int *n, double values_new[], doub
   roll_area = left_area = values[0] * (*width_before + *width_after);
   
   // Apply rolling window
-  for (int i = 1; i < *n; i++) {
+  for (ptrdiff_t i = 1; i < *n; i++) {
     // Remove truncated area on left and right end
     roll_area -= (left_area + right_area);
     
@@ -145,7 +155,7 @@ void sma_next(double values[], double times[], int *n, double values_new[], doub
 
 
 // SMA_linear(X, width)
-void sma_linear(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after)
+void sma_linear(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after)
 {
   // values     ... array of time series values
   // times      ... array of observation times
@@ -154,7 +164,7 @@ void sma_linear(double values[], double times[], int *n, double values_new[], do
   // width_before ... (non-negative) width of rolling window before t_i
   // width_after  ... (non-negative) width of rolling window after t_i
   
-  int left = 0, right = 0;
+  ptrdiff_t left = 0, right = 0;
   double t_left_new, t_right_new, roll_area, left_area, right_area = 0;
   
   // Trivial case
@@ -166,7 +176,7 @@ void sma_linear(double values[], double times[], int *n, double values_new[], do
   roll_area = left_area = values[0] * (*width_before + *width_after);
   
   // Apply rolling window
-  for (int i = 1; i < *n; i++) {   
+  for (ptrdiff_t i = 1; i < *n; i++) {   
     // Remove truncated area on left and right end
     roll_area -= (left_area + right_area);
     
@@ -197,3 +207,663 @@ void sma_linear(double values[], double times[], int *n, double values_new[], do
   }
 }
 
+
+// Value of the time series between the j-th and (j+1)-th observation, averaged over time
+static double segment_value(double values[], ptrdiff_t j, int type)
+{
+  if (type == SMA_LAST)
+    return values[j];
+  if (type == SMA_NEXT)
+    return values[j+1];
+  return (values[j] + values[j+1]) / 2;
+}
+
+
+/*
+SMA with 64-bit integer observation times, e.g. nanoseconds since the epoch
+-) the rolling windows are determined with exact integer arithmetic, using the difference of two observation
+   times instead of a shifted time, which cannot overflow for non-negative widths
+-) time differences are only converted to double for the areas, measured relative to t_i, so that they are exact
+   for windows of less than 2^53 time units; the results then agree with sma_last, sma_next and sma_linear
+-) a width of INT64_MAX stands for an infinite width
+*/
+static void sma_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before,
+  int64_t *width_after, int type)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... array of length *n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // type         ... SMA_LAST, SMA_NEXT, or SMA_LINEAR
+  
+  ptrdiff_t left = 0, right = 0, prev, next;
+  double width = (double) *width_before + (double) *width_after;
+  double roll_area, left_area, right_area = 0, left_gap, right_gap;
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Initialize output
+  values_new[0] = values[0];
+  roll_area = left_area = values[0] * width;
+  
+  // Apply rolling window
+  for (ptrdiff_t i = 1; i < *n; i++) {
+    // Remove truncated area on left and right end
+    roll_area -= (left_area + right_area);
+    
+    // Expand interval on right end
+    while ((right < *n - 1) && (times[right + 1] - times[i] <= *width_after)) {
+      right++;
+      roll_area += segment_value(values, right - 1, type) * (double) (times[right] - times[right - 1]);
+    }
+    
+    // Shrink interval on left end
+    while (times[i] - times[left] > *width_before) {
+      roll_area -= segment_value(values, left, type) * (double) (times[left+1] - times[left]);
+      left++;
+    }
+    
+    // Add truncated area on left and right end, where t_i - width_before <= times[left] <= t_i and
+    // t_i <= times[right] <= t_i + width_after
+    prev = MAX(0, left-1);
+    next = MIN(right+1, *n-1);
+    left_gap = (double) (times[left] - times[i] + *width_before);
+    right_gap = (double) (times[i] - times[right] + *width_after);
+    if (type == SMA_LAST) {
+      left_area = values[prev] * left_gap;
+      right_area = values[right] * right_gap;
+    } else if (type == SMA_NEXT) {
+      left_area = values[left] * left_gap;
+      right_area = values[right] * right_gap;
+    } else {
+      left_area = trapezoid_left((double) (times[prev] - times[i]), -(double) *width_before,
+        (double) (times[left] - times[i]), values[prev], values[left]);
+      right_area = trapezoid_right((double) (times[right] - times[i]), (double) *width_after,
+        (double) (times[next] - times[i]), values[right], values[next]);
+    }
+    roll_area += left_area + right_area;
+    
+    // Save SMA value for current time window
+    values_new[i] = roll_area / width;
+  }
+}
+
+
+void sma_last_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before,
+  int64_t *width_after)
+{
+  sma_int64(values, times, n, values_new, width_before, width_after, SMA_LAST);
+}
+
+
+void sma_next_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before,
+  int64_t *width_after)
+{
+  sma_int64(values, times, n, values_new, width_before, width_after, SMA_NEXT);
+}
+
+
+void sma_linear_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before,
+  int64_t *width_after)
+{
+  sma_int64(values, times, n, values_new, width_before, width_after, SMA_LINEAR);
+}
+
+
+/*
+SMA with the rolling windows of a window index
+-) the last observation of each window is taken from the index; the first one is the first observation of the
+   window in the index, or an earlier one exactly at t_i - width_before, which lies in the closed SMA window but not
+   in the half-open window of the rolling_* kernels
+-) the index must be built from 'times' with the same widths and without limits on the number of observations;
+   the results then agree exactly with sma_last, sma_next and sma_linear
+*/
+static void sma_window(double values[], double times[], window_index *index, double values_new[], double *width_before,
+  double *width_after, int type)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // index        ... window index of the observation times
+  // values_new   ... array of length index->n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // type         ... SMA_LAST, SMA_NEXT, or SMA_LINEAR
+  
+  ptrdiff_t n = index->n, left = 0, right = 0, first, last, prev, next;
+  double t_left_new, t_right_new, roll_area, left_area, right_area = 0;
+  
+  // Trivial case
+  if (n == 0)
+    return;
+  
+  // Initialize output
+  values_new[0] = values[0];
+  roll_area = left_area = values[0] * (*width_before + *width_after);
+  
+  // Apply rolling window
+  for (ptrdiff_t i = 1; i < n; i++) {
+    // Remove truncated area on left and right end
+    roll_area -= (left_area + right_area);
+    
+    // Expand interval on right end
+    t_right_new = times[i] + *width_after;
+    last = window_index_right(index, i);
+    while (right < last) {
+      right++;
+      roll_area += segment_value(values, right - 1, type) * (times[right] - times[right - 1]);
+    }
+    
+    // Shrink interval on left end
+    t_left_new = times[i] - *width_before;
+    first = window_index_left(index, i);
+    while ((first > 0) && (times[first - 1] >= t_left_new))
+      first--;
+    while (left < first) {
+      roll_area -= segment_value(values, left, type) * (times[left+1] - times[left]);
+      left++;
+    }
+    
+    // Add truncated area on left and right end
+    prev = MAX(0, left-1);
+    next = MIN(right+1, n-1);
+    if (type == SMA_LAST) {
+      left_area = values[prev] * (times[left] - t_left_new);
+      right_area = values[right] * (t_right_new - times[right]);
+    } else if (type == SMA_NEXT) {
+      left_area = values[left] * (times[left] - t_left_new);
+      right_area = values[right] * (t_right_new - times[right]);
+    } else {
+      left_area = trapezoid_left(times[prev], t_left_new, times[left], values[prev], values[left]);
+      right_area = trapezoid_right(times[right], t_right_new, times[next], values[right], values[next]);
+    }
+    roll_area += left_area + right_area;
+    
+    // Save SMA value for current time window
+    values_new[i] = roll_area / (*width_before + *width_after);
+  }
+}
+
+
+void sma_last_window(double values[], double times[], window_index *index, double values_new[], double *width_before,
+  double *width_after)
+{
+  sma_window(values, times, index, values_new, width_before, width_after, SMA_LAST);
+}
+
+
+void sma_next_window(double values[], double times[], window_index *index, double values_new[], double *width_before,
+  double *width_after)
+{
+  sma_window(values, times, index, values_new, width_before, width_after, SMA_NEXT);
+}
+
+
+void sma_linear_window(double values[], double times[], window_index *index, double values_new[], double *width_before,
+  double *width_after)
+{
+  sma_window(values, times, index, values_new, width_before, width_after, SMA_LINEAR);
+}
+
+
+// SMA of each column of a matrix, with all columns sharing the same observation times
+// -) the window boundaries are determined once and then applied to blocks of MATRIX_BLOCK columns at a time
+static void sma_columns(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after, int type)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  // type         ... SMA_LAST, SMA_NEXT, or SMA_LINEAR
+  
+  ptrdiff_t left = 0, right = 0;
+  ptrdiff_t *lefts, *rights;
+  double width = *width_before + *width_after;
+  double roll_area[MATRIX_BLOCK], left_area[MATRIX_BLOCK], right_area[MATRIX_BLOCK];
+  
+  // Trivial case
+  if (*n == 0)
+    return;
+  
+  // Determine the rolling windows
+  lefts = malloc(*n * sizeof(ptrdiff_t));
+  rights = malloc(*n * sizeof(ptrdiff_t));
+  lefts[0] = rights[0] = 0;
+  for (ptrdiff_t i = 1; i < *n; i++) {
+    while ((right < *n - 1) && (times[right + 1] <= times[i] + *width_after))
+      right++;
+    while (times[left] < times[i] - *width_before)
+      left++;
+    lefts[i] = left;
+    rights[i] = right;
+  }
+  
+  for (int col = 0; col < *ncol; col += MATRIX_BLOCK) {
+    int num_cols = (*ncol - col < MATRIX_BLOCK) ? *ncol - col : MATRIX_BLOCK;
+    double *x = values + (size_t) col * *n, *out = values_new + (size_t) col * *n;
+    double t_left_new, t_right_new, *y;
+    
+    // Initialize output
+    left = right = 0;
+    for (int b = 0; b < num_cols; b++) {
+      y = x + (size_t) b * *n;
+      out[(size_t) b * *n] = y[0];
+      roll_area[b] = left_area[b] = y[0] * width;
+      right_area[b] = 0;
+    }
+    
+    // Apply rolling window
+    for (ptrdiff_t i = 1; i < *n; i++) {
+      // Remove truncated area on left and right end
+      for (int b = 0; b < num_cols; b++)
+        roll_area[b] -= (left_area[b] + right_area[b]);
+      
+      // Expand interval on right end
+      t_right_new = times[i] + *width_after;
+      for (; right < rights[i]; right++) {
+        double dt = times[right + 1] - times[right];
+        for (int b = 0; b < num_cols; b++) {
+          y = x + (size_t) b * *n;
+          if (type == SMA_LAST)
+            roll_area[b] += y[right] * dt;
+          else if (type == SMA_NEXT)
+            roll_area[b] += y[right + 1] * dt;
+          else
+            roll_area[b] += (y[right + 1] + y[right])/2 * dt;
+        }
+      }
+      
+      // Shrink interval on left end
+      t_left_new = times[i] - *width_before;
+      for (; left < lefts[i]; left++) {
+        double dt = times[left + 1] - times[left];
+        for (int b = 0; b < num_cols; b++) {
+          y = x + (size_t) b * *n;
+          if (type == SMA_LAST)
+            roll_area[b] -= y[left] * dt;
+          else if (type == SMA_NEXT)
+            roll_area[b] -= y[left + 1] * dt;
+          else
+            roll_area[b] -= (y[left] + y[left + 1]) / 2 * dt;
+        }
+      }
+      
+      // Add truncated area on left and right end, and save SMA value for current time window
+      for (int b = 0; b < num_cols; b++) {
+        y = x + (size_t) b * *n;
+        if (type == SMA_LAST) {
+          left_area[b] = y[MAX(0, left-1)] * (times[left] - t_left_new);
+          right_area[b] = y[right] * (t_right_new - times[right]);
+        } else if (type == SMA_NEXT) {
+          left_area[b] = y[left] * (times[left] - t_left_new);
+          right_area[b] = y[right] * (t_right_new - times[right]);
+        } else {
+          left_area[b] = trapezoid_left(times[MAX(0, left-1)], t_left_new, times[left],
+            y[MAX(0, left-1)], y[left]);
+          right_area[b] = trapezoid_right(times[right], t_right_new, times[MIN(right+1, *n-1)],
+            y[right], y[MIN(right+1, *n-1)]);
+        }
+        roll_area[b] += left_area[b] + right_area[b];
+        out[(size_t) b * *n + i] = roll_area[b] / width;
+      }
+    }
+  }
+  free(lefts);
+  free(rights);
+}
+
+
+// SMA_last(X, width) for each column of a matrix of observation values
+void sma_last_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  sma_columns(values, times, n, ncol, values_new, width_before, width_after, SMA_LAST);
+}
+
+
+// SMA_next(X, width) for each column of a matrix of observation values
+void sma_next_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  sma_columns(values, times, n, ncol, values_new, width_before, width_after, SMA_NEXT);
+}
+
+
+// SMA_linear(X, width) for each column of a matrix of observation values
+void sma_linear_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... column-major matrix of time series values with *n rows and *ncol columns
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. number of rows of 'values' and length of 'times'
+  // ncol         ... number of time series, i.e. number of columns of 'values'
+  // values_new   ... column-major matrix of the same dimension as 'values' to store output values
+  // width_before ... (non-negative) width of rolling window before t_i
+  // width_after  ... (non-negative) width of rolling window after t_i
+  
+  sma_columns(values, times, n, ncol, values_new, width_before, width_after, SMA_LINEAR);
+}
+
+
+// SMA for several rolling windows, see rolling_multi_kernel in rolling.h
+// -) each window keeps its own rolling area, so the results equal those of sma_last, sma_next and sma_linear
+static void sma_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows, int type)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  // type         ... SMA_LAST, SMA_NEXT, or SMA_LINEAR
+  
+  ptrdiff_t *lefts, *rights, left, right;
+  double *roll_area, *left_area, *right_area, t_left_new, t_right_new, dt;
+  
+  // Trivial case
+  if ((*n == 0) || (*num_windows == 0))
+    return;
+  
+  // State of each rolling window, initialized with the first observation
+  lefts = malloc(*num_windows * sizeof(ptrdiff_t));
+  rights = malloc(*num_windows * sizeof(ptrdiff_t));
+  roll_area = malloc(*num_windows * sizeof(double));
+  left_area = malloc(*num_windows * sizeof(double));
+  right_area = malloc(*num_windows * sizeof(double));
+  for (ptrdiff_t k = 0; k < *num_windows; k++) {
+    lefts[k] = rights[k] = 0;
+    values_new[(size_t) k * *n] = values[0];
+    roll_area[k] = left_area[k] = values[0] * (width_before[k] + width_after[k]);
+    right_area[k] = 0;
+  }
+  
+  // Apply rolling windows
+  for (ptrdiff_t i = 1; i < *n; i++) {
+    for (ptrdiff_t k = 0; k < *num_windows; k++) {
+      left = lefts[k];
+      right = rights[k];
+      
+      // Remove truncated area on left and right end
+      roll_area[k] -= (left_area[k] + right_area[k]);
+      
+      // Expand interval on right end
+      t_right_new = times[i] + width_after[k];
+      while ((right < *n - 1) && (times[right + 1] <= t_right_new)) {
+        right++;
+        dt = times[right] - times[right - 1];
+        if (type == SMA_LAST)
+          roll_area[k] += values[right - 1] * dt;
+        else if (type == SMA_NEXT)
+          roll_area[k] += values[right] * dt;
+        else
+          roll_area[k] += (values[right] + values[right - 1])/2 * dt;
+      }
+      
+      // Shrink interval on left end
+      t_left_new = times[i] - width_before[k];
+      while (times[left] < t_left_new) {
+        dt = times[left+1] - times[left];
+        if (type == SMA_LAST)
+          roll_area[k] -= values[left] * dt;
+        else if (type == SMA_NEXT)
+          roll_area[k] -= values[left+1] * dt;
+        else
+          roll_area[k] -= (values[left] + values[left+1]) / 2 * dt;
+        left++;
+      }
+      
+      // Add truncated area on left and right end
+      if (type == SMA_LAST) {
+        left_area[k] = values[MAX(0, left-1)] * (times[left] - t_left_new);
+        right_area[k] = values[right] * (t_right_new - times[right]);
+      } else if (type == SMA_NEXT) {
+        left_area[k] = values[left] * (times[left] - t_left_new);
+        right_area[k] = values[right] * (t_right_new - times[right]);
+      } else {
+        left_area[k] = trapezoid_left(times[MAX(0, left-1)], t_left_new, times[left],
+          values[MAX(0, left-1)], values[left]);
+        right_area[k] = trapezoid_right(times[right], t_right_new, times[MIN(right+1, *n-1)],
+          values[right], values[MIN(right+1, *n-1)]);
+      }
+      roll_area[k] += left_area[k] + right_area[k];
+      
+      // Save SMA value for current time window
+      values_new[(size_t) k * *n + i] = roll_area[k] / (width_before[k] + width_after[k]);
+      lefts[k] = left;
+      rights[k] = right;
+    }
+  }
+  
+  free(lefts);
+  free(rights);
+  free(roll_area);
+  free(left_area);
+  free(right_area);
+}
+
+
+// SMA_last(X, width) for several rolling windows
+void sma_last_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  
+  sma_multi(values, times, n, values_new, width_before, width_after, num_windows, SMA_LAST);
+}
+
+
+// SMA_next(X, width) for several rolling windows
+void sma_next_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  
+  sma_multi(values, times, n, values_new, width_before, width_after, num_windows, SMA_NEXT);
+}
+
+
+// SMA_linear(X, width) for several rolling windows
+void sma_linear_multi(double values[], double times[], ptrdiff_t *n, double values_new[],
+  double width_before[], double width_after[], ptrdiff_t *num_windows)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // values_new   ... column-major matrix with *n rows and *num_windows columns to store output values
+  // width_before ... array of (non-negative) widths of rolling windows before t_i
+  // width_after  ... array of (non-negative) widths of rolling windows after t_i
+  // num_windows  ... number of rolling windows, i.e. length of 'width_before' and 'width_after'
+  
+  sma_multi(values, times, n, values_new, width_before, width_after, num_windows, SMA_LINEAR);
+}
+
+
+/*
+SMA at arbitrary query times
+-) the rolling window of a query time t is [t - width_before, t + width_after], and its area is updated
+   incrementally as in sma_last, sma_next and sma_linear, merging the query times with the observation times so
+   that the run time is O(n + m)
+-) the time series is extended with its first value before the first observation and with its last value after
+   the last observation; the result is NaN for query times before the first observation
+-) at an observation time the result equals that of sma_last, sma_next or sma_linear, except that for SMA_NEXT
+   the part of the window after the last observation in it uses the value of the next observation, as required by
+   the interpolation, instead of that of the last one
+*/
+static void sma_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[],
+  double *width_before, double *width_after, int type)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // times_new    ... array of non-decreasing query times
+  // n_new        ... number of query times, i.e. length of 'times_new'
+  // values_new   ... array of length *n_new to store the SMA at the query times
+  // width_before ... (non-negative) width of rolling window before the query time
+  // width_after  ... (non-negative) width of rolling window after the query time
+  // type         ... SMA_LAST, SMA_NEXT, or SMA_LINEAR
+  
+  ptrdiff_t left = 0, right = 0, j = 0;
+  double t_left_new, t_right_new, roll_area, left_area, right_area = 0, dt;
+  double width = *width_before + *width_after;
+  
+  // Trivial case
+  if (*n == 0) {
+    for (j = 0; j < *n_new; j++)
+      values_new[j] = NAN;
+    return;
+  }
+  
+  // No observation yet
+  for (; (j < *n_new) && (times_new[j] < times[0]); j++)
+    values_new[j] = NAN;
+  
+  // Initialize with the window ending at the first observation
+  roll_area = left_area = values[0] * width;
+  
+  // Apply rolling window
+  for (; j < *n_new; j++) {
+    // Window after the last observation
+    // -) the time series is constant there, and the window does not move back for later query times
+    t_left_new = times_new[j] - *width_before;
+    if (t_left_new > times[*n - 1]) {
+      for (; j < *n_new; j++)
+        values_new[j] = values[*n - 1];
+      break;
+    }
+    
+    // Remove truncated area on left and right end
+    roll_area -= (left_area + right_area);
+    
+    // Expand interval on right end
+    t_right_new = times_new[j] + *width_after;
+    while ((right < *n - 1) && (times[right + 1] <= t_right_new)) {
+      right++;
+      dt = times[right] - times[right - 1];
+      if (type == SMA_LAST)
+        roll_area += values[right - 1] * dt;
+      else if (type == SMA_NEXT)
+        roll_area += values[right] * dt;
+      else
+        roll_area += (values[right] + values[right - 1])/2 * dt;
+    }
+    
+    // Shrink interval on left end
+    while (times[left] < t_left_new) {
+      dt = times[left+1] - times[left];
+      if (type == SMA_LAST)
+        roll_area -= values[left] * dt;
+      else if (type == SMA_NEXT)
+        roll_area -= values[left+1] * dt;
+      else
+        roll_area -= (values[left] + values[left+1]) / 2 * dt;
+      left++;
+    }
+    
+    // Add truncated area on left and right end
+    if (type == SMA_LAST) {
+      left_area = values[MAX(0, left-1)] * (times[left] - t_left_new);
+      right_area = values[right] * (t_right_new - times[right]);
+    } else if (type == SMA_NEXT) {
+      // -) a query time is usually between two observations, where the time series has the value of the next one
+      left_area = values[left] * (times[left] - t_left_new);
+      right_area = values[MIN(right+1, *n-1)] * (t_right_new - times[right]);
+    } else {
+      left_area = trapezoid_left(times[MAX(0, left-1)], t_left_new, times[left],
+        values[MAX(0, left-1)], values[left]);
+      right_area = trapezoid_right(times[right], t_right_new, times[MIN(right+1, *n-1)],
+        values[right], values[MIN(right+1, *n-1)]);
+    }
+    roll_area += left_area + right_area;
+    
+    // Save SMA value for current time window
+    values_new[j] = roll_area / width;
+  }
+}
+
+
+// SMA_last(X, width) at arbitrary query times
+void sma_last_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // times_new    ... array of non-decreasing query times
+  // n_new        ... number of query times, i.e. length of 'times_new'
+  // values_new   ... array of length *n_new to store the SMA at the query times
+  // width_before ... (non-negative) width of rolling window before the query time
+  // width_after  ... (non-negative) width of rolling window after the query time
+  
+  sma_at(values, times, n, times_new, n_new, values_new, width_before, width_after, SMA_LAST);
+}
+
+
+// SMA_next(X, width) at arbitrary query times
+void sma_next_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // times_new    ... array of non-decreasing query times
+  // n_new        ... number of query times, i.e. length of 'times_new'
+  // values_new   ... array of length *n_new to store the SMA at the query times
+  // width_before ... (non-negative) width of rolling window before the query time
+  // width_after  ... (non-negative) width of rolling window after the query time
+  
+  sma_at(values, times, n, times_new, n_new, values_new, width_before, width_after, SMA_NEXT);
+}
+
+
+// SMA_linear(X, width) at arbitrary query times
+void sma_linear_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[],
+  double *width_before, double *width_after)
+{
+  // values       ... array of time series values
+  // times        ... array of observation times
+  // n            ... number of observations, i.e. length of 'values' and 'times'
+  // times_new    ... array of non-decreasing query times
+  // n_new        ... number of query times, i.e. length of 'times_new'
+  // values_new   ... array of length *n_new to store the SMA at the query times
+  // width_before ... (non-negative) width of rolling window before the query time
+  // width_after  ... (non-negative) width of rolling window after the query time
+  
+  sma_at(values, times, n, times_new, n_new, values_new, width_before, width_after, SMA_LINEAR);
+}
@@ -5,8 +5,35 @@
 #ifndef _sma_h
 #define _sma_h
 
-void sma_last(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void sma_next(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
-void sma_linear(double values[], double times[], int *n, double values_new[], double *width_before, double *width_after);
+#include <stddef.h>
+#include <stdint.h>
+#include "window_index.h"
+
+double trapezoid_left(double x1, double x2, double x3, double y1, double y3);
+double trapezoid_right(double x1, double x2, double x3, double y1, double y3);
+
+void sma_last(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void sma_next(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+void sma_linear(double values[], double times[], ptrdiff_t *n, double values_new[], double *width_before, double *width_after);
+
+void sma_last_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before, int64_t *width_after);
+void sma_next_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before, int64_t *width_after);
+void sma_linear_int64(double values[], int64_t times[], ptrdiff_t *n, double values_new[], int64_t *width_before, int64_t *width_after);
+
+void sma_last_window(double values[], double times[], window_index *index, double values_new[], double *width_before, double *width_after);
+void sma_next_window(double values[], double times[], window_index *index, double values_new[], double *width_before, double *width_after);
+void sma_linear_window(double values[], double times[], window_index *index, double values_new[], double *width_before, double *width_after);
+
+void sma_last_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[], double *width_before, double *width_after);
+void sma_next_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[], double *width_before, double *width_after);
+void sma_linear_matrix(double values[], double times[], ptrdiff_t *n, int *ncol, double values_new[], double *width_before, double *width_after);
+
+void sma_last_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double width_before[], double width_after[], ptrdiff_t *num_windows);
+void sma_next_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double width_before[], double width_after[], ptrdiff_t *num_windows);
+void sma_linear_multi(double values[], double times[], ptrdiff_t *n, double values_new[], double width_before[], double width_after[], ptrdiff_t *num_windows);
+
+void sma_last_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[], double *width_before, double *width_after);
+void sma_next_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[], double *width_before, double *width_after);
+void sma_linear_at(double values[], double times[], ptrdiff_t *n, double times_new[], ptrdiff_t *n_new, double values_new[], double *width_before, double *width_after);
 
 #endif
@@ -1,7 +1,60 @@
 #include <Rcpp.h>
+#include <algorithm>
 
 extern "C" {
 #include "sma.h"
+#include "rolling.h"
+}
+
+#include "buffers.h"
+#include "int64_times.h"
+#include "kernel_names.h"
+
+// SMA kernels for integer observation times
+typedef void (*sma_int64_kernel)(double values[], int64_t times[], ptrdiff_t *n, double values_new[],
+                                 int64_t *width_before, int64_t *width_after);
+
+// Apply a SMA kernel, optionally splitting the output range across threads, or its version for integer
+// observation times, for which 'threads' is ignored
+static Rcpp::NumericVector sma_apply(rolling_kernel kernel,
+                                     sma_int64_kernel int64_kernel,
+                                     SEXP times,
+                                     Rcpp::NumericVector values,
+                                     TimeWidth widthbefore,
+                                     TimeWidth widthafter,
+                                     int threads,
+                                     int grain) {
+  if (XLENGTH(times) != values.size()) Rcpp::stop("Matching vectors needed.");
+  R_xlen_t n = values.size();
+  Rcpp::NumericVector res(n);
+  if (is_int64_times(times)) {
+    int64_t before = widthbefore.int64(), after = widthafter.int64();
+    if (before == INT64_MAX || after == INT64_MAX) Rcpp::stop("Finite window widths needed.");
+    int64_kernel(values.begin(), int64_times(times), &n, res.begin(), &before, &after);
+    return res;
+  }
+  Rcpp::DatetimeVector t(times);
+  if (threads > 1)
+    rolling_apply_parallel(kernel, values.begin(), t.begin(), &n, res.begin(),
+                           widthbefore.ptr(), widthafter.ptr(), &grain, &threads);
+  else
+    kernel(values.begin(), t.begin(), &n, res.begin(), widthbefore.ptr(), widthafter.ptr());
+  return res;
+}
+
+// Apply a SMA kernel to each column of a matrix
+static Rcpp::NumericMatrix sma_apply_matrix(rolling_matrix_kernel kernel,
+                                            Rcpp::DatetimeVector times,
+                                            Rcpp::NumericMatrix values,
+                                            double widthbefore,
+                                            double widthafter) {
+  if (times.size() != values.nrow()) Rcpp::stop("Matching rows needed.");
+  R_xlen_t n = values.nrow();
+  int ncol = values.ncol();
+  Rcpp::NumericMatrix res(n, ncol);
+  kernel(values.begin(), times.begin(), &n, &ncol, res.begin(), &widthbefore, &widthafter);
+  res.attr("dimnames") = values.attr("dimnames");
+  return res;
 }
 
 //' The UTS library by Andreas Eckner provides algorithms for unevenly
@@ -10,11 +63,27 @@ extern "C" {
 //' average, or SMA, for short. Three variants are provides considering
 //' the last or next observation relative to time \sQuote{t}, as well as
 //' linear interpolation between them.
+//'
+//' The SMA weights each value by the time it is in force within the
+//' rolling window, so the window is always a time span; unlike
+//' \code{\link{rollingMean}}, the SMA operators have no limits on the
+//' number of observations in the window.
 //' @title SMA functions for unevenly spaced time series
-//' @param times A Datetime vector
+//' @param times A Datetime vector, or a nanotime or integer64 vector with
+//' integer times, e.g. nanoseconds, for which the rolling windows are
+//' determined exactly in integer arithmetic
 //' @param values A numeric vector
-//' @param widthbefore A double with the preceding observation width
+//' @param widthbefore A double, or an integer64 value such as a
+//' nanoduration, with the preceding observation width, in the unit of the
+//' times (i.e. whole nanoseconds for nanotime)
 //' @param widthafter gvA double with the subsequent observation width
+//' @param threads An integer with the number of threads; values above one
+//' split the series into chunks which are processed in parallel. It is
+//' ignored for integer times.
+//' @param grain An integer with the number of observations per chunk, or
+//' zero for four chunks per thread. Each chunk also processes the
+//' observations within one window width of its boundaries, so the grain
+//' should be large relative to the number of observations per window.
 //' @return A numeric vector with SMA-weighted values.
 //' package at the given position is available.
 //' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
@@ -38,42 +107,144 @@ extern "C" {
 //'               col=c("black", "lightblue", "darkblue", "mediumblue"))
 //' }
 // [[Rcpp::export]]
-Rcpp::NumericVector SMAnext(Rcpp::DatetimeVector times,
+Rcpp::NumericVector SMAnext(SEXP times,
                             Rcpp::NumericVector values,
-                            const double widthbefore,
-                            const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  sma_next(values.begin(), times.begin(), &n, res.begin(),
-           const_cast<double*>(&widthbefore), const_cast<double*>(&widthafter));
-  return res;
+                            const TimeWidth widthbefore,
+                            const TimeWidth widthafter,
+                            int threads = 1,
+                            int grain = 0) {
+  return sma_apply(sma_next, sma_next_int64, times, values, widthbefore, widthafter, threads, grain);
 }
 
 //' @rdname SMAnext
 // [[Rcpp::export]]
-Rcpp::NumericVector SMAlast(Rcpp::DatetimeVector times,
+Rcpp::NumericVector SMAlast(SEXP times,
                             Rcpp::NumericVector values,
-                            const double widthbefore,
-                            const double widthafter) {
-  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  sma_last(values.begin(), times.begin(), &n, res.begin(), 
-           const_cast<double*>(&widthbefore), const_cast<double*>(&widthafter));
-  return res;
+                            const TimeWidth widthbefore,
+                            const TimeWidth widthafter,
+                            int threads = 1,
+                            int grain = 0) {
+  return sma_apply(sma_last, sma_last_int64, times, values, widthbefore, widthafter, threads, grain);
 }
 
 //' @rdname SMAnext
 // [[Rcpp::export]]
-Rcpp::NumericVector SMAlinear(Rcpp::DatetimeVector times,
+Rcpp::NumericVector SMAlinear(SEXP times,
                               Rcpp::NumericVector values,
-                              const double widthbefore,
-                              const double widthafter) {
+                              const TimeWidth widthbefore,
+                              const TimeWidth widthafter,
+                              int threads = 1,
+                              int grain = 0) {
+  return sma_apply(sma_linear, sma_linear_int64, times, values, widthbefore, widthafter, threads, grain);
+}
+
+//' @rdname rollingMeanMatrix
+// [[Rcpp::export]]
+Rcpp::NumericMatrix SMAnextMatrix(Rcpp::DatetimeVector times,
+                                  Rcpp::NumericMatrix values,
+                                  const TimeWidth widthbefore,
+                                  const TimeWidth widthafter) {
+  return sma_apply_matrix(sma_next_matrix, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMatrix
+// [[Rcpp::export]]
+Rcpp::NumericMatrix SMAlastMatrix(Rcpp::DatetimeVector times,
+                                  Rcpp::NumericMatrix values,
+                                  const TimeWidth widthbefore,
+                                  const TimeWidth widthafter) {
+  return sma_apply_matrix(sma_last_matrix, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMatrix
+// [[Rcpp::export]]
+Rcpp::NumericMatrix SMAlinearMatrix(Rcpp::DatetimeVector times,
+                                    Rcpp::NumericMatrix values,
+                                    const TimeWidth widthbefore,
+                                    const TimeWidth widthafter) {
+  return sma_apply_matrix(sma_linear_matrix, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMulti
+// [[Rcpp::export]]
+Rcpp::NumericMatrix SMAnextMulti(Rcpp::DatetimeVector times,
+                                 Rcpp::NumericVector values,
+                                 Rcpp::NumericVector widthbefore,
+                                 Rcpp::NumericVector widthafter) {
+  return rolling_apply_multi(sma_next_multi, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMulti
+// [[Rcpp::export]]
+Rcpp::NumericMatrix SMAlastMulti(Rcpp::DatetimeVector times,
+                                 Rcpp::NumericVector values,
+                                 Rcpp::NumericVector widthbefore,
+                                 Rcpp::NumericVector widthafter) {
+  return rolling_apply_multi(sma_last_multi, times, values, widthbefore, widthafter);
+}
+
+//' @rdname rollingMeanMulti
+// [[Rcpp::export]]
+Rcpp::NumericMatrix SMAlinearMulti(Rcpp::DatetimeVector times,
+                                   Rcpp::NumericVector values,
+                                   Rcpp::NumericVector widthbefore,
+                                   Rcpp::NumericVector widthafter) {
+  return rolling_apply_multi(sma_linear_multi, times, values, widthbefore, widthafter);
+}
+
+//' @rdname EMAat
+//' @param widthbefore A double with the preceding observation width
+//' @param widthafter A double with the subsequent observation width
+// [[Rcpp::export]]
+Rcpp::NumericVector SMAat(Rcpp::DatetimeVector times,
+                          Rcpp::NumericVector values,
+                          Rcpp::DatetimeVector at,
+                          const TimeWidth widthbefore,
+                          const TimeWidth widthafter,
+                          const std::string type = "last") {
   if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
-  int n = times.size();
-  Rcpp::NumericVector res(n);
-  sma_linear(values.begin(), times.begin(), &n, res.begin(), 
-           const_cast<double*>(&widthbefore), const_cast<double*>(&widthafter));
+  if (!std::is_sorted(at.begin(), at.end())) Rcpp::stop("Non-decreasing output times needed.");
+  R_xlen_t n = times.size(), m = at.size();
+  Rcpp::NumericVector res(m);
+  if (type == "last")
+    sma_last_at(values.begin(), times.begin(), &n, at.begin(), &m, res.begin(),
+                widthbefore.ptr(), widthafter.ptr());
+  else if (type == "next")
+    sma_next_at(values.begin(), times.begin(), &n, at.begin(), &m, res.begin(),
+                widthbefore.ptr(), widthafter.ptr());
+  else if (type == "linear")
+    sma_linear_at(values.begin(), times.begin(), &n, at.begin(), &m, res.begin(),
+                  widthbefore.ptr(), widthafter.ptr());
+  else
+    Rcpp::stop("Unknown SMA type '" + type + "'.");
   return res;
 }
+
+//' @rdname EMAinto
+//' @param widthbefore A double with the preceding observation width
+//' @param widthafter A double with the subsequent observation width
+//' @param threads An integer with the number of threads, see
+//' \code{\link{SMAnext}}
+//' @param grain An integer with the number of observations per chunk, see
+//' \code{\link{SMAnext}}
+// [[Rcpp::export]]
+SEXP SMAinto(SEXP times,
+             SEXP values,
+             SEXP out,
+             TimeWidth widthbefore,
+             TimeWidth widthafter,
+             const std::string type = "last",
+             int threads = 1,
+             int grain = 0) {
+  Rcpp::NumericVector t = double_buffer(times, "times"), v = double_buffer(values, "values"),
+    res = double_buffer(out, "out");
+  check_buffers(t, v, res);
+  rolling_kernel kernel = sma_kernel_named(type);
+  R_xlen_t n = t.size();
+  if (threads > 1)
+    rolling_apply_parallel(kernel, v.begin(), t.begin(), &n, res.begin(),
+                           widthbefore.ptr(), widthafter.ptr(), &grain, &threads);
+  else
+    kernel(v.begin(), t.begin(), &n, res.begin(), widthbefore.ptr(), widthafter.ptr());
+  return out;
+}
@@ -0,0 +1,544 @@
+#include <cmath>
+#include <math.h>
+#include <stdexcept>
+#include "streaming.h"
+
+extern "C" {
+#include "ema.h"
+#include "sma.h"
+}
+
+// Snapshot header: magic bytes and format version
+static const char snapshot_magic[4] = {'U', 'T', 'S', 'S'};
+static const uint32_t snapshot_version = 1;
+
+
+void state_writer::put(const std::deque<observation> &obs)
+{
+  put((uint64_t) obs.size());
+  for (std::deque<observation>::const_iterator it = obs.begin(); it != obs.end(); ++it) {
+    put(it->time);
+    put(it->value);
+  }
+}
+
+
+void state_reader::get(std::deque<observation> &obs)
+{
+  uint64_t size;
+  double time, value;
+
+  get(size);
+  require(size, 2 * sizeof(double));
+  obs.clear();
+  for (uint64_t k = 0; k < size; k++) {
+    get(time);
+    get(value);
+    obs.push_back(observation(time, value));
+  }
+}
+
+
+void state_reader::require(uint64_t count, size_t size) const
+{
+  if (count > (uint64_t) (end - pos) / size)
+    throw std::invalid_argument("Truncated streaming operator snapshot.");
+}
+
+
+// Throw if a restored operator state is inconsistent
+static void check_state(bool ok)
+{
+  if (!ok)
+    throw std::invalid_argument("Inconsistent streaming operator snapshot.");
+}
+
+
+double streaming_operator::push(double time, double value)
+{
+  if ((count > 0) && (time < last_time))
+    throw std::range_error("Observation times must be non-decreasing.");
+
+  double res = update(time, value);
+  count++;
+  last_time = time;
+  return res;
+}
+
+
+std::vector<unsigned char> streaming_operator::save() const
+{
+  std::vector<unsigned char> buffer;
+  state_writer out(buffer);
+  std::string name = type();
+
+  for (int k = 0; k < 4; k++)
+    out.put(snapshot_magic[k]);
+  out.put(snapshot_version);
+  out.put((uint32_t) name.size());
+  for (size_t k = 0; k < name.size(); k++)
+    out.put(name[k]);
+  save_state(out);
+  return buffer;
+}
+
+
+void streaming_operator::save_state(state_writer &out) const
+{
+  out.put(count);
+  out.put(last_time);
+}
+
+
+void streaming_operator::load_state(state_reader &in)
+{
+  in.get(count);
+  in.get(last_time);
+  check_state(count >= 0);
+}
+
+
+ema_stream::ema_stream(stream_interpolation interpolation, double tau) :
+  interpolation(interpolation), tau(tau), ema(0), last_value(0)
+{
+}
+
+
+std::string ema_stream::type() const
+{
+  if (interpolation == STREAM_LAST)
+    return "EMAlast";
+  if (interpolation == STREAM_NEXT)
+    return "EMAnext";
+  return "EMAlinear";
+}
+
+
+void ema_stream::save_state(state_writer &out) const
+{
+  streaming_operator::save_state(out);
+  out.put(tau);
+  out.put(ema);
+  out.put(last_value);
+}
+
+
+void ema_stream::load_state(state_reader &in)
+{
+  streaming_operator::load_state(in);
+  in.get(tau);
+  in.get(ema);
+  in.get(last_value);
+}
+
+
+double ema_stream::update(double time, double value)
+{
+  int ema_type = (interpolation == STREAM_LAST) ? EMA_LAST : ((interpolation == STREAM_NEXT) ? EMA_NEXT : EMA_LINEAR);
+
+  if (count == 0)
+    ema = value;
+  else
+    ema = ema_step(ema, last_value, value, time - last_time, tau, ema_type);
+  last_value = value;
+  return ema;
+}
+
+
+sma_stream::sma_stream(stream_interpolation interpolation, double width) :
+  interpolation(interpolation), width(width), first(0), left(0), roll_area(0), left_area(0)
+{
+}
+
+
+std::string sma_stream::type() const
+{
+  if (interpolation == STREAM_LAST)
+    return "SMAlast";
+  if (interpolation == STREAM_NEXT)
+    return "SMAnext";
+  return "SMAlinear";
+}
+
+
+void sma_stream::save_state(state_writer &out) const
+{
+  streaming_operator::save_state(out);
+  out.put(width);
+  out.put(first);
+  out.put(left);
+  out.put(roll_area);
+  out.put(left_area);
+  out.put(obs);
+}
+
+
+void sma_stream::load_state(state_reader &in)
+{
+  streaming_operator::load_state(in);
+  in.get(width);
+  in.get(first);
+  in.get(left);
+  in.get(roll_area);
+  in.get(left_area);
+  in.get(obs);
+  check_state((first >= 0) && (first <= ((left > 0) ? left - 1 : 0)) && (first + (int64_t) obs.size() == count) &&
+    ((count == 0) || (left < count)));
+}
+
+
+// Same updates as sma_last, sma_next and sma_linear with width_after = 0, so that the truncated area on the
+// right end of the rolling window is always zero
+double sma_stream::update(double time, double value)
+{
+  obs.push_back(observation(time, value));
+
+  // Initialize with the first observation
+  if (count == 0) {
+    roll_area = left_area = value * width;
+    return value;
+  }
+
+  // Remove truncated area on left end
+  roll_area -= left_area;
+
+  // Expand interval on right end
+  const observation &prev = at(count - 1);
+  if (interpolation == STREAM_LAST)
+    roll_area += prev.value * (time - prev.time);
+  else if (interpolation == STREAM_NEXT)
+    roll_area += value * (time - prev.time);
+  else
+    roll_area += (value + prev.value) / 2 * (time - prev.time);
+
+  // Shrink interval on left end
+  double t_left_new = time - width;
+  while (at(left).time < t_left_new) {
+    const observation &a = at(left), &b = at(left + 1);
+    if (interpolation == STREAM_LAST)
+      roll_area -= a.value * (b.time - a.time);
+    else if (interpolation == STREAM_NEXT)
+      roll_area -= b.value * (b.time - a.time);
+    else
+      roll_area -= (a.value + b.value) / 2 * (b.time - a.time);
+    left++;
+  }
+
+  // Add truncated area on left end
+  const observation &l = at(left), &l_prev = at((left > 0) ? left - 1 : 0);
+  if (interpolation == STREAM_LAST)
+    left_area = l_prev.value * (l.time - t_left_new);
+  else if (interpolation == STREAM_NEXT)
+    left_area = l.value * (l.time - t_left_new);
+  else
+    left_area = trapezoid_left(l_prev.time, t_left_new, l.time, l_prev.value, l.value);
+  roll_area += left_area;
+
+  // Drop observations that are no longer needed for the truncated area on the left end
+  while (first < left - 1) {
+    obs.pop_front();
+    first++;
+  }
+
+  return roll_area / width;
+}
+
+
+void rolling_stream::save_state(state_writer &out) const
+{
+  streaming_operator::save_state(out);
+  out.put(width);
+  out.put(first);
+  out.put(window);
+}
+
+
+void rolling_stream::load_state(state_reader &in)
+{
+  streaming_operator::load_state(in);
+  in.get(width);
+  in.get(first);
+  in.get(window);
+  check_state((first >= 0) && (first + (int64_t) window.size() == count));
+}
+
+
+double rolling_stream::update(double time, double value)
+{
+  // Expand window on the right
+  window.push_back(observation(time, value));
+  add(count, value);
+
+  // Shrink window on the left to get half-open interval
+  while (!window.empty() && (window.front().time <= time - width)) {
+    remove(first, window.front().value);
+    window.pop_front();
+    first++;
+  }
+
+  return current();
+}
+
+
+void rolling_sum_stream::save_state(state_writer &out) const
+{
+  rolling_stream::save_state(out);
+  out.put(roll_sum);
+}
+
+
+void rolling_sum_stream::load_state(state_reader &in)
+{
+  rolling_stream::load_state(in);
+  in.get(roll_sum);
+}
+
+
+double rolling_sum_stream::current()
+{
+  if (!mean)
+    return roll_sum;
+  if (!window.empty())   // non-empty window
+    return roll_sum / window.size();
+  return NAN;            // empty window
+}
+
+
+void rolling_extremum_stream::save_state(state_writer &out) const
+{
+  rolling_stream::save_state(out);
+  out.put((uint64_t) candidates.size());
+  for (size_t k = 0; k < candidates.size(); k++) {
+    out.put(candidates[k].first);
+    out.put(candidates[k].second);
+  }
+}
+
+
+void rolling_extremum_stream::load_state(state_reader &in)
+{
+  uint64_t size;
+  int64_t pos;
+  double value;
+
+  rolling_stream::load_state(in);
+  in.get(size);
+  in.require(size, sizeof(int64_t) + sizeof(double));
+  candidates.clear();
+  for (uint64_t k = 0; k < size; k++) {
+    in.get(pos);
+    in.get(value);
+    check_state((pos >= first) && (pos < count));
+    candidates.push_back(std::make_pair(pos, value));
+  }
+}
+
+
+void rolling_extremum_stream::add(int64_t pos, double value)
+{
+  // Drop candidates dominated by the new observation; for ties the most recent position is kept, and NaN
+  // values are skipped as in rolling_max and rolling_min
+  if (std::isnan(value))
+    return;
+  while (!candidates.empty() &&
+    (maximum ? (value >= candidates.back().second) : (value <= candidates.back().second)))
+    candidates.pop_back();
+  candidates.push_back(std::make_pair(pos, value));
+}
+
+
+void rolling_extremum_stream::remove(int64_t pos, double)
+{
+  while (!candidates.empty() && (candidates.front().first <= pos))
+    candidates.pop_front();
+}
+
+
+double rolling_extremum_stream::current()
+{
+  if (!candidates.empty())   // non-empty window
+    return candidates.front().second;
+  return maximum ? -INFINITY : INFINITY;
+}
+
+
+// The two halves of the window are rebuilt from the window observations
+void rolling_median_stream::load_state(state_reader &in)
+{
+  rolling_stream::load_state(in);
+  low.clear();
+  high.clear();
+  for (std::deque<observation>::const_iterator it = window.begin(); it != window.end(); ++it)
+    add(0, it->value);
+}
+
+
+// NaN values are skipped, as they would break the ordering of the halves
+void rolling_median_stream::add(int64_t, double value)
+{
+  if (std::isnan(value))
+    return;
+  if (low.empty() || (value <= *low.rbegin()))
+    low.insert(value);
+  else
+    high.insert(value);
+  rebalance();
+}
+
+
+void rolling_median_stream::remove(int64_t, double value)
+{
+  std::multiset<double>::iterator it;
+
+  if (std::isnan(value))
+    return;
+  if (!low.empty() && (value <= *low.rbegin())) {
+    if ((it = low.find(value)) != low.end())
+      low.erase(it);
+  } else if ((it = high.find(value)) != high.end())
+    high.erase(it);
+  rebalance();
+}
+
+
+void rolling_median_stream::rebalance()
+{
+  while (low.size() > high.size() + 1) {
+    high.insert(*low.rbegin());
+    low.erase(--low.end());
+  }
+  while (high.size() > low.size()) {
+    low.insert(*high.begin());
+    high.erase(high.begin());
+  }
+}
+
+
+double rolling_median_stream::current()
+{
+  if (low.empty())
+    return NAN;
+  if (low.size() > high.size())   // odd number of elements
+    return *low.rbegin();
+  return (*low.rbegin() + *high.begin()) / 2;
+}
+
+
+rolling_var_stream::rolling_var_stream(double width, bool sd) :
+  rolling_stream(width), sd(sd), rebase_pos(-1)
+{
+  moment_sums_reset(&ms, 0);
+}
+
+
+void rolling_var_stream::save_state(state_writer &out) const
+{
+  rolling_stream::save_state(out);
+  out.put(ms.shift);
+  for (int k = 0; k < 4; k++) {
+    out.put(ms.sum[k]);
+    out.put(ms.comp[k]);
+  }
+  out.put(rebase_pos);
+}
+
+
+void rolling_var_stream::load_state(state_reader &in)
+{
+  rolling_stream::load_state(in);
+  in.get(ms.shift);
+  for (int k = 0; k < 4; k++) {
+    in.get(ms.sum[k]);
+    in.get(ms.comp[k]);
+  }
+  in.get(rebase_pos);
+}
+
+
+double rolling_var_stream::current()
+{
+  ptrdiff_t count = (ptrdiff_t) window.size();
+  double m2, m3, m4;
+
+  // Recalculate the power sums around the window mean once all observations of the last rebase have left
+  if (first > rebase_pos) {
+    moment_sums_reset(&ms, (count > 0) ? ms.shift + ms.sum[0] / count : ms.shift);
+    for (std::deque<observation>::const_iterator it = window.begin(); it != window.end(); ++it)
+      moment_sums_update(&ms, it->value, 1);
+    rebase_pos = first + count - 1;
+  }
+
+  if (count < 2)   // less than two observations in time window
+    return NAN;
+  moment_sums_central(&ms, count, &m2, &m3, &m4);
+  return sd ? sqrt(m2 / (count - 1)) : m2 / (count - 1);
+}
+
+
+streaming_operator *streaming_operator_create(const std::string &type, double param)
+{
+  if (type == "EMAlast")
+    return new ema_stream(STREAM_LAST, param);
+  if (type == "EMAnext")
+    return new ema_stream(STREAM_NEXT, param);
+  if (type == "EMAlinear")
+    return new ema_stream(STREAM_LINEAR, param);
+  if (type == "SMAlast")
+    return new sma_stream(STREAM_LAST, param);
+  if (type == "SMAnext")
+    return new sma_stream(STREAM_NEXT, param);
+  if (type == "SMAlinear")
+    return new sma_stream(STREAM_LINEAR, param);
+  if (type == "rollingSum")
+    return new rolling_sum_stream(param, false);
+  if (type == "rollingMean")
+    return new rolling_sum_stream(param, true);
+  if (type == "rollingMax")
+    return new rolling_extremum_stream(param, true);
+  if (type == "rollingMin")
+    return new rolling_extremum_stream(param, false);
+  if (type == "rollingMedian")
+    return new rolling_median_stream(param);
+  if (type == "rollingVar")
+    return new rolling_var_stream(param, false);
+  if (type == "rollingSD")
+    return new rolling_var_stream(param, true);
+  return NULL;
+}
+
+
+streaming_operator *streaming_operator_load(const unsigned char *data, size_t size)
+{
+  state_reader in(data, size);
+  char magic[4];
+  uint32_t version, length;
+  std::string name;
+  streaming_operator *op;
+
+  // Header
+  for (int k = 0; k < 4; k++)
+    in.get(magic[k]);
+  if (memcmp(magic, snapshot_magic, 4) != 0)
+    throw std::invalid_argument("Not a streaming operator snapshot.");
+  in.get(version);
+  if (version != snapshot_version)
+    throw std::invalid_argument("Unsupported streaming operator snapshot version.");
+  in.get(length);
+  in.require(length, 1);
+  name.resize(length);
+  for (uint32_t k = 0; k < length; k++)
+    in.get(name[k]);
+
+  // Operator state, including the operator parameter
+  if ((op = streaming_operator_create(name, 1)) == NULL)
+    throw std::invalid_argument("Unknown operator type '" + name + "' in streaming operator snapshot.");
+  try {
+    op->load_state(in);
+    if (!in.done())
+      throw std::invalid_argument("Trailing data in streaming operator snapshot.");
+  } catch (...) {
+    delete op;
+    throw;
+  }
+  return op;
+}
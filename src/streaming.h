@@ -0,0 +1,244 @@
+// Streaming versions of the EMA, SMA and rolling operators
+// -) an operator keeps the observations and partial results of its current window, so that each new
+//    observation is processed in amortized O(1) time (O(log w) for the rolling median of w observations)
+// -) rolling windows are trailing windows (i.e. width_after = 0), because later observations are not yet known
+// -) for strictly increasing observation times, the output agrees with the corresponding batch operator with
+//    width_after = 0, up to rounding; for tied observation times the batch operators already include the later
+//    tied observations, while a streaming operator only includes the observations pushed so far
+// -) the state of an operator can be saved to a compact binary snapshot and restored later, e.g. after a restart;
+//    snapshots use the byte order of the machine that created them
+
+#ifndef _streaming_h
+#define _streaming_h
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "rolling.h"
+}
+
+// Interpolation of observation values between observation times
+enum stream_interpolation { STREAM_LAST, STREAM_NEXT, STREAM_LINEAR };
+
+
+// Observation time and value
+struct observation {
+  double time, value;
+  observation(double time_, double value_) : time(time_), value(value_) {}
+};
+
+
+// Append fixed-size values to a binary snapshot
+class state_writer {
+public:
+  state_writer(std::vector<unsigned char> &buffer) : buffer(buffer) {}
+
+  template <class T> void put(const T &value) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(&value);
+    buffer.insert(buffer.end(), p, p + sizeof(T));
+  }
+  void put(const std::deque<observation> &obs);
+
+private:
+  std::vector<unsigned char> &buffer;
+};
+
+
+// Read fixed-size values from a binary snapshot
+// -) throws std::invalid_argument if the snapshot ends before 'count' more values of the given size
+class state_reader {
+public:
+  state_reader(const unsigned char *data, size_t size) : pos(data), end(data + size) {}
+
+  template <class T> void get(T &value) {
+    require(1, sizeof(T));
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+  }
+  void get(std::deque<observation> &obs);
+  void require(uint64_t count, size_t size) const;
+  bool done() const { return pos == end; }
+
+private:
+  const unsigned char *pos, *end;
+};
+
+
+// Base class of all streaming operators
+class streaming_operator {
+public:
+  virtual ~streaming_operator() {}
+
+  // Add the next observation and return the operator value at its observation time
+  // -) throws std::range_error if the observation time is before that of the previous observation
+  double push(double time, double value);
+
+  // Name of the corresponding batch operator, e.g. "EMAnext" or "rollingMedian"
+  virtual std::string type() const = 0;
+
+  // Binary snapshot of the operator state, which can be restored by streaming_operator_load
+  std::vector<unsigned char> save() const;
+
+  // Write or read the state of the operator, including its parameter
+  virtual void save_state(state_writer &out) const;
+  virtual void load_state(state_reader &in);
+
+protected:
+  streaming_operator() : count(0), last_time(0) {}
+
+  // Process the next observation; 'count' and 'last_time' still refer to the previous observations
+  virtual double update(double time, double value) = 0;
+
+  int64_t count;       // number of observations pushed so far
+  double last_time;    // observation time of the last observation
+};
+
+
+// EMA_next, EMA_last and EMA_linear
+class ema_stream : public streaming_operator {
+public:
+  ema_stream(stream_interpolation interpolation, double tau);
+  std::string type() const;
+  void save_state(state_writer &out) const;
+  void load_state(state_reader &in);
+
+protected:
+  double update(double time, double value);
+
+  stream_interpolation interpolation;
+  double tau;           // half-life of EMA kernel
+  double ema;           // EMA value at the time of the last observation
+  double last_value;    // value of the last observation
+};
+
+
+// SMA_next, SMA_last and SMA_linear with a trailing window
+class sma_stream : public streaming_operator {
+public:
+  sma_stream(stream_interpolation interpolation, double width);
+  std::string type() const;
+  void save_state(state_writer &out) const;
+  void load_state(state_reader &in);
+
+protected:
+  double update(double time, double value);
+  const observation &at(int64_t pos) const { return obs[pos - first]; }
+
+  stream_interpolation interpolation;
+  double width;                    // width of rolling window
+  std::deque<observation> obs;     // observations from position max(0, left - 1) onwards
+  int64_t first;                   // position of the first observation in 'obs'
+  int64_t left;                    // position of the first observation in the rolling window
+  double roll_area, left_area;     // area in the rolling window, and truncated area on its left end
+};
+
+
+// Base class of rolling operators over the observations in the time window (t - width, t]
+class rolling_stream : public streaming_operator {
+public:
+  void save_state(state_writer &out) const;
+  void load_state(state_reader &in);
+
+protected:
+  rolling_stream(double width) : width(width), first(0) {}
+
+  double update(double time, double value);
+
+  // Add or remove an observation, identified by its position, and calculate the operator value of the window
+  virtual void add(int64_t pos, double value) = 0;
+  virtual void remove(int64_t pos, double value) = 0;
+  virtual double current() = 0;
+
+  double width;                    // width of rolling window
+  std::deque<observation> window;  // observations in the rolling window
+  int64_t first;                   // position of the first observation in the rolling window
+};
+
+
+// Rolling sum and mean
+class rolling_sum_stream : public rolling_stream {
+public:
+  rolling_sum_stream(double width, bool mean) : rolling_stream(width), mean(mean), roll_sum(0) {}
+  std::string type() const { return mean ? "rollingMean" : "rollingSum"; }
+  void save_state(state_writer &out) const;
+  void load_state(state_reader &in);
+
+protected:
+  void add(int64_t, double value) { roll_sum = roll_sum + value; }
+  void remove(int64_t, double value) { roll_sum = roll_sum - value; }
+  double current();
+
+  bool mean;
+  double roll_sum;
+};
+
+
+// Rolling maximum and minimum, using a monotonic deque of candidate positions and values
+class rolling_extremum_stream : public rolling_stream {
+public:
+  rolling_extremum_stream(double width, bool maximum) : rolling_stream(width), maximum(maximum) {}
+  std::string type() const { return maximum ? "rollingMax" : "rollingMin"; }
+  void save_state(state_writer &out) const;
+  void load_state(state_reader &in);
+
+protected:
+  void add(int64_t pos, double value);
+  void remove(int64_t pos, double);
+  double current();
+
+  bool maximum;
+  std::deque<std::pair<int64_t, double> > candidates;
+};
+
+
+// Rolling median, using the lower and upper half of the window values
+class rolling_median_stream : public rolling_stream {
+public:
+  rolling_median_stream(double width) : rolling_stream(width) {}
+  std::string type() const { return "rollingMedian"; }
+  void load_state(state_reader &in);
+
+protected:
+  void add(int64_t, double value);
+  void remove(int64_t, double value);
+  double current();
+  void rebalance();
+
+  std::multiset<double> low, high;   // low has as many elements as high, or one more
+};
+
+
+// Rolling variance and standard deviation, using the incrementally updated power sums of rolling_var
+class rolling_var_stream : public rolling_stream {
+public:
+  rolling_var_stream(double width, bool sd);
+  std::string type() const { return sd ? "rollingSD" : "rollingVar"; }
+  void save_state(state_writer &out) const;
+  void load_state(state_reader &in);
+
+protected:
+  void add(int64_t, double value) { moment_sums_update(&ms, value, 1); }
+  void remove(int64_t, double value) { moment_sums_update(&ms, value, -1); }
+  double current();
+
+  bool sd;
+  moment_sums ms;
+  int64_t rebase_pos;   // recalculate the power sums once all observations up to this position have left
+};
+
+
+// Create the streaming operator for the batch operator with the given name, or return NULL for unknown names
+// -) 'param' is the half-life tau for EMA operators, and the width of the trailing window otherwise
+streaming_operator *streaming_operator_create(const std::string &type, double param);
+
+// Restore a streaming operator from a snapshot created by streaming_operator::save
+// -) throws std::invalid_argument if the snapshot is corrupt or was created by an incompatible version
+streaming_operator *streaming_operator_load(const unsigned char *data, size_t size);
+
+#endif
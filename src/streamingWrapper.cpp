@@ -0,0 +1,88 @@
+#include <Rcpp.h>
+
+#include "streaming.h"
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here offer streaming versions of the EMA, SMA
+//' and rolling operators, which keep the state of their rolling window
+//' between calls so that new observations can be processed as they arrive,
+//' without recomputing the whole series.
+//'
+//' An operator is created by \code{streamOperator} and fed by
+//' \code{streamPush}, which returns the operator values at the new
+//' observation times. Observation times must be non-decreasing across all
+//' calls. Since later observations are not yet known, SMA and rolling
+//' operators use a trailing window, and agree with the corresponding batch
+//' function with \code{widthafter = 0} as long as observation times are
+//' distinct.
+//' @title Streaming operators for unevenly spaced time series
+//' @param type A character string with the name of the corresponding batch
+//' function, one of \code{"EMAlast"}, \code{"EMAnext"}, \code{"EMAlinear"},
+//' \code{"SMAlast"}, \code{"SMAnext"}, \code{"SMAlinear"},
+//' \code{"rollingSum"}, \code{"rollingMean"}, \code{"rollingMax"},
+//' \code{"rollingMin"}, \code{"rollingMedian"}, \code{"rollingVar"} or
+//' \code{"rollingSD"}.
+//' @param param A double with the decay factor for EMA operators, and the
+//' preceding observation width for all others.
+//' @return For \code{streamOperator} and \code{streamLoad}, an external
+//' pointer to the new operator; for \code{streamPush}, a numeric vector
+//' with the operator values at the given observation times; for
+//' \code{streamSave}, a raw vector.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @examples
+//' times <- ISOdatetime(2010, 1, 2, 8, 30, 0) + c(0, 1.0, 1.2, 2.3, 2.9, 5.0)
+//' values <- seq(0, 10, by=2)
+//' op <- streamOperator("SMAlast", 2)
+//' c(streamPush(op, times[1:3], values[1:3]), streamPush(op, times[4:6], values[4:6]))
+//' SMAlast(times, values, 2, 0)
+//' op <- streamOperator("rollingMedian", 2)
+//' invisible(streamPush(op, times[1:4], values[1:4]))
+//' state <- streamSave(op)
+//' streamPush(streamLoad(state), times[5:6], values[5:6])
+// [[Rcpp::export]]
+Rcpp::XPtr<streaming_operator> streamOperator(const std::string type,
+                                              const double param) {
+  streaming_operator *op = streaming_operator_create(type, param);
+  if (op == NULL) Rcpp::stop("Unknown operator type '" + type + "'.");
+  return Rcpp::XPtr<streaming_operator>(op, true);
+}
+
+//' @rdname streamOperator
+//' @param op An external pointer to a streaming operator
+//' @param times A Datetime vector
+//' @param values A numeric vector
+// [[Rcpp::export]]
+Rcpp::NumericVector streamPush(Rcpp::XPtr<streaming_operator> op,
+                               Rcpp::DatetimeVector times,
+                               Rcpp::NumericVector values) {
+  if (times.size() != values.size()) Rcpp::stop("Matching vectors needed.");
+  R_xlen_t n = times.size();
+  Rcpp::NumericVector res(n);
+  for (R_xlen_t i = 0; i < n; i++)
+    res[i] = op->push(times[i], values[i]);
+  return res;
+}
+
+//' @rdname streamOperator
+//' @param state A raw vector with a snapshot created by \code{streamSave}
+//' @details \code{streamSave} returns a compact binary snapshot of the
+//' operator state, i.e. the observations in its window, its accumulators
+//' and the last observation time, which \code{streamLoad} restores into a
+//' new operator. This allows e.g. a restarted process to resume without
+//' replaying all previous observations. Snapshots use the byte order of
+//' the machine that created them.
+// [[Rcpp::export]]
+Rcpp::RawVector streamSave(Rcpp::XPtr<streaming_operator> op) {
+  std::vector<unsigned char> state = op->save();
+  Rcpp::RawVector res(state.size());
+  std::copy(state.begin(), state.end(), res.begin());
+  return res;
+}
+
+//' @rdname streamOperator
+// [[Rcpp::export]]
+Rcpp::XPtr<streaming_operator> streamLoad(Rcpp::RawVector state) {
+  return Rcpp::XPtr<streaming_operator>(streaming_operator_load(state.begin(), state.size()), true);
+}
@@ -0,0 +1,325 @@
+// License: GPL-2 | GPL-3
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tdigest.h"
+
+// Maximum number of sorted runs merged by merge_runs()
+#define MAX_RUNS 16
+
+
+/******************* Helper functions ********************/
+
+// Inverse of the scale function k_1 of Dunning & Ertl (2019), mapping a centroid index to a quantile
+static inline double tdigest_scale_inverse(double k, double compression)
+{
+  if (k >= compression / 4)
+    return 1;
+  return (sin(2 * M_PI * k / compression) + 1) / 2;
+}
+
+
+// Scale function k_1 of Dunning & Ertl (2019), mapping a quantile to a centroid index
+static inline double tdigest_scale(double q, double compression)
+{
+  if (q <= 0)
+    return -compression / 4;
+  if (q >= 1)
+    return compression / 4;
+  return compression / (2 * M_PI) * asin(2 * q - 1);
+}
+
+
+// Merge two sorted runs of centroids into 'out', multiplying the weights of each run by its scale
+static int merge_two(tdigest_centroid a[], int n_a, double scale_a, tdigest_centroid b[], int n_b,
+  double scale_b, tdigest_centroid out[])
+{
+  int i = 0, j = 0, k = 0;
+  
+  while ((i < n_a) && (j < n_b)) {
+    if (b[j].mean < a[i].mean) {
+      out[k].mean = b[j].mean;
+      out[k++].weight = b[j++].weight * scale_b;
+    } else {
+      out[k].mean = a[i].mean;
+      out[k++].weight = a[i++].weight * scale_a;
+    }
+  }
+  for (; i < n_a; i++, k++) {
+    out[k].mean = a[i].mean;
+    out[k].weight = a[i].weight * scale_a;
+  }
+  for (; j < n_b; j++, k++) {
+    out[k].mean = b[j].mean;
+    out[k].weight = b[j].weight * scale_b;
+  }
+  return k;
+}
+
+
+/*
+Merge sorted runs of centroids into 'out', multiplying the weights of each run by its scale
+-) the runs are merged one after the other into the result so far, alternating between 'out' and 'tmp' such
+   that the last merge writes to 'out'; both need room for all centroids
+*/
+static int merge_runs(tdigest_centroid *runs[], int lengths[], double scales[], int num_runs,
+  tdigest_centroid out[], tdigest_centroid tmp[])
+{
+  int nonempty[MAX_RUNS], num = 0, size;
+  tdigest_centroid *dst, *src;
+  
+  for (int r = 0; r < num_runs; r++) {
+    if (lengths[r] > 0)
+      nonempty[num++] = r;
+  }
+  
+  // Trivial cases
+  if (num == 0)
+    return 0;
+  if (num == 1)
+    return merge_two(runs[nonempty[0]], lengths[nonempty[0]], scales[nonempty[0]], NULL, 0, 1, out);
+  
+  dst = (num % 2 == 0) ? out : tmp;
+  size = merge_two(runs[nonempty[0]], lengths[nonempty[0]], scales[nonempty[0]],
+    runs[nonempty[1]], lengths[nonempty[1]], scales[nonempty[1]], dst);
+  for (int r = 2; r < num; r++) {
+    src = dst;
+    dst = (src == out) ? tmp : out;
+    size = merge_two(src, size, 1, runs[nonempty[r]], lengths[nonempty[r]], scales[nonempty[r]], dst);
+  }
+  return size;
+}
+
+
+// Merge adjacent sorted centroids in 'in' into 'out' as long as they span at most one unit of the scale function
+static int compress_sorted(tdigest_centroid in[], int size, double total, double compression,
+  tdigest_centroid out[])
+{
+  int num = 0;
+  double weight_before = 0, weight_limit, w;
+  
+  // Trivial case
+  if (size == 0)
+    return 0;
+  
+  out[0] = in[0];
+  weight_limit = total * tdigest_scale_inverse(tdigest_scale(0, compression) + 1, compression);
+  for (int j = 1; j < size; j++) {
+    w = out[num].weight + in[j].weight;
+    if (weight_before + w <= weight_limit) {
+      out[num].mean = out[num].mean + (in[j].mean - out[num].mean) * in[j].weight / w;
+      out[num].weight = w;
+    } else {
+      weight_before = weight_before + out[num].weight;
+      weight_limit = total * tdigest_scale_inverse(tdigest_scale(weight_before / total, compression) + 1,
+        compression);
+      out[++num] = in[j];
+    }
+  }
+  return num + 1;
+}
+
+
+/****************** END: Helper functions ****************/
+
+
+// Initialize an empty digest
+void tdigest_init(tdigest *td, double compression)
+{
+  // td          ... digest
+  // compression ... accuracy parameter (e.g. 100)
+  
+  td->compression = (compression < 10) ? 10 : compression;
+  td->capacity = 2 * (int) ceil(td->compression) + 16;
+  td->centroids = malloc(td->capacity * sizeof(tdigest_centroid));
+  td->scratch = malloc(4 * td->capacity * sizeof(tdigest_centroid));
+  tdigest_reset(td);
+}
+
+
+void tdigest_free(tdigest *td)
+{
+  free(td->centroids);
+  free(td->scratch);
+  td->centroids = td->scratch = NULL;
+}
+
+
+// Remove all observations
+void tdigest_reset(tdigest *td)
+{
+  td->size = td->compressed = 0;
+  td->total = 0;
+  td->min = INFINITY;
+  td->max = -INFINITY;
+}
+
+
+// Add an observation with the given weight, keeping the uncompressed centroids sorted and few
+void tdigest_add(tdigest *td, double value, double weight)
+{
+  int pos;
+  
+  if ((td->size == td->capacity) || (td->size - td->compressed >= td->compression / 4))
+    tdigest_compress(td);
+  pos = td->size;
+  while ((pos > td->compressed) && (td->centroids[pos - 1].mean > value)) {
+    td->centroids[pos] = td->centroids[pos - 1];
+    pos--;
+  }
+  td->centroids[pos].mean = value;
+  td->centroids[pos].weight = weight;
+  td->size++;
+  td->total = td->total + weight;
+  if (value < td->min)
+    td->min = value;
+  if (value > td->max)
+    td->max = value;
+}
+
+
+// Add all observations of another digest, with their weights multiplied by 'scale', and compress the result
+void tdigest_merge(tdigest *td, tdigest *other, double scale)
+{
+  tdigest_centroid *runs[4];
+  int lengths[4], size;
+  double scales[4] = { 1, 1, scale, scale };
+  
+  runs[0] = td->centroids;
+  lengths[0] = td->compressed;
+  runs[1] = td->centroids + td->compressed;
+  lengths[1] = td->size - td->compressed;
+  runs[2] = other->centroids;
+  lengths[2] = other->compressed;
+  runs[3] = other->centroids + other->compressed;
+  lengths[3] = other->size - other->compressed;
+  if (lengths[0] + lengths[1] + lengths[2] + lengths[3] > 2 * td->capacity) {
+    tdigest_compress(td);
+    tdigest_compress(other);
+    lengths[0] = td->size;
+    lengths[1] = 0;
+    lengths[2] = other->size;
+    lengths[3] = 0;
+  }
+  size = merge_runs(runs, lengths, scales, 4, td->scratch, td->scratch + 2 * td->capacity);
+  
+  td->total = td->total + scale * other->total;
+  if (other->min < td->min)
+    td->min = other->min;
+  if (other->max > td->max)
+    td->max = other->max;
+  td->size = td->compressed = compress_sorted(td->scratch, size, td->total, td->compression, td->centroids);
+}
+
+
+// Replace the observations by those of another digest with the same compression
+void tdigest_copy(tdigest *td, tdigest *other)
+{
+  memcpy(td->centroids, other->centroids, other->size * sizeof(tdigest_centroid));
+  td->size = other->size;
+  td->compressed = other->compressed;
+  td->total = other->total;
+  td->min = other->min;
+  td->max = other->max;
+}
+
+
+// Merge the added observations into the compressed centroids
+void tdigest_compress(tdigest *td)
+{
+  tdigest_centroid *runs[2];
+  int lengths[2], size;
+  double scales[2] = { 1, 1 };
+  
+  // Trivial case
+  if (td->compressed == td->size)
+    return;
+  
+  runs[0] = td->centroids;
+  lengths[0] = td->compressed;
+  runs[1] = td->centroids + td->compressed;
+  lengths[1] = td->size - td->compressed;
+  size = merge_runs(runs, lengths, scales, 2, td->scratch, td->scratch + 2 * td->capacity);
+  td->size = td->compressed = compress_sorted(td->scratch, size, td->total, td->compression, td->centroids);
+}
+
+
+/*
+Replace the observations by the union of those of several digests, with the weights of each digest multiplied
+by its scale
+-) the centroids are merged in sorted order, but not compressed, which is cheaper if the result is only used
+   for quantiles; the capacity of 'td' is increased as needed
+*/
+void tdigest_union(tdigest *td, tdigest *parts[], double scales[], int num_parts)
+{
+  // td        ... digest to store the union
+  // parts     ... array of (at most MAX_RUNS / 2) digests
+  // scales    ... array of weight multipliers of the digests
+  // num_parts ... number of digests
+  
+  tdigest_centroid *runs[MAX_RUNS];
+  int lengths[MAX_RUNS], size = 0;
+  double run_scales[MAX_RUNS];
+  
+  tdigest_reset(td);
+  for (int k = 0; k < num_parts; k++) {
+    runs[2 * k] = parts[k]->centroids;
+    lengths[2 * k] = parts[k]->compressed;
+    runs[2 * k + 1] = parts[k]->centroids + parts[k]->compressed;
+    lengths[2 * k + 1] = parts[k]->size - parts[k]->compressed;
+    run_scales[2 * k] = run_scales[2 * k + 1] = scales[k];
+    size = size + parts[k]->size;
+    td->total = td->total + scales[k] * parts[k]->total;
+    if (parts[k]->min < td->min)
+      td->min = parts[k]->min;
+    if (parts[k]->max > td->max)
+      td->max = parts[k]->max;
+  }
+  if (size > td->capacity) {
+    td->capacity = size;
+    td->centroids = realloc(td->centroids, td->capacity * sizeof(tdigest_centroid));
+    td->scratch = realloc(td->scratch, 4 * td->capacity * sizeof(tdigest_centroid));
+  }
+  td->size = td->compressed = merge_runs(runs, lengths, run_scales, 2 * num_parts, td->centroids, td->scratch);
+}
+
+
+/*
+Approximate quantile of the observations
+-) the centroid means are placed at the middle of their cumulative weight and interpolated linearly, with
+   the smallest and largest observation at the ends
+-) returns NaN for an empty digest
+*/
+double tdigest_quantile(tdigest *td, double p)
+{
+  // td ... digest
+  // p  ... probability between zero and one
+  
+  double index, center, center_next;
+  tdigest_centroid *c;
+  
+  // Trivial case
+  if (td->total <= 0)
+    return NAN;
+  
+  tdigest_compress(td);
+  c = td->centroids;
+  index = p * td->total;
+  
+  // Between the smallest observation and the first centroid
+  center = c[0].weight / 2;
+  if (index <= center)
+    return (center > 0) ? td->min + (c[0].mean - td->min) * index / center : td->min;
+  
+  // Between two centroids
+  for (int j = 0; j < td->size - 1; j++) {
+    center_next = center + (c[j].weight + c[j + 1].weight) / 2;
+    if (index <= center_next)
+      return c[j].mean + (c[j + 1].mean - c[j].mean) * (index - center) / (center_next - center);
+    center = center_next;
+  }
+  
+  // Between the last centroid and the largest observation
+  return c[td->size - 1].mean + (td->max - c[td->size - 1].mean) * (index - center) / (td->total - center);
+}
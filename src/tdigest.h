@@ -0,0 +1,42 @@
+// License: GPL-2 | GPL-3
+// Remark: To facilitate interfaces to other programming languages such as R, all variables are either pointers or arrays
+
+#ifndef _tdigest_h
+#define _tdigest_h
+
+/*
+Merging t-digest of Dunning & Ertl (2019) for approximate quantiles
+-) the observations are summarized by at most about 'compression' centroids (weighted means), which are small
+   near the tails of the distribution, so that extreme quantiles have a small rank error
+-) digests are mergeable, i.e. the digest of the union of two samples is obtained from their digests
+-) the centroids consist of two runs sorted by their mean: the compressed centroids, followed by the
+   observations added since the last compression, so that digests are combined by linear merges
+-) as long as no centroids have been merged, quantiles equal those of R's quantile(type = 5)
+*/
+typedef struct {
+  double mean;
+  double weight;
+} tdigest_centroid;
+
+typedef struct {
+  double compression;           // accuracy parameter, larger values use more centroids
+  int size;                     // number of centroids
+  int compressed;               // number of compressed centroids at the start of 'centroids'
+  int capacity;                 // number of centroids before the digest is compressed
+  tdigest_centroid *centroids;
+  tdigest_centroid *scratch;    // buffer of four times the capacity used for merging
+  double total;                 // total weight of all centroids
+  double min, max;              // smallest and largest observation
+} tdigest;
+
+void tdigest_init(tdigest *td, double compression);
+void tdigest_free(tdigest *td);
+void tdigest_reset(tdigest *td);
+void tdigest_add(tdigest *td, double value, double weight);
+void tdigest_merge(tdigest *td, tdigest *other, double scale);
+void tdigest_copy(tdigest *td, tdigest *other);
+void tdigest_compress(tdigest *td);
+void tdigest_union(tdigest *td, tdigest *parts[], double scales[], int num_parts);
+double tdigest_quantile(tdigest *td, double p);
+
+#endif
@@ -15,7 +15,7 @@ extern "C" {
 
 
 // Print nicely formatted observation times and values for an unevenly spaced time series
-void print_uts(double values[], double times[], int n)
+void print_uts(double values[], double times[], ptrdiff_t n)
 {
   // values     ... array of observation values
   // times      ... array of observation times
@@ -26,7 +26,7 @@ void print_uts(double values[], double times[], int n)
   Rprintf("Time    Value\n");
   Rprintf("-------------\n");
 
-  for (int i=0; i < n; i++)
+  for (ptrdiff_t i=0; i < n; i++)
     Rprintf("%.1f %9.2f\n", times[i], values[i]); 
 }
 
@@ -45,7 +45,7 @@ void utsExample() {
   // Define sample time series
   double values[] = {0, 2, 4, 6, 8, 10};
   double times[] = {0, 1, 1.2, 2.3, 2.9, 5};
-  int n = sizeof(values) / sizeof(double);
+  ptrdiff_t n = sizeof(values) / sizeof(double);
   double out[n];
   Rprintf("Input time series X\n");
   print_uts(values, times, n);
@@ -0,0 +1,136 @@
+#include <Rcpp.h>
+#include <math.h>
+#include <vector>
+
+#include "RcppUTS_types.h"
+#include "int64_times.h"
+#include "kernel_names.h"
+
+// Apply a rolling or SMA kernel to the observation times of a time index
+static Rcpp::NumericVector index_apply(rolling_kernel kernel,
+                                       TimeIndex index,
+                                       Rcpp::NumericVector values,
+                                       double widthbefore,
+                                       double widthafter,
+                                       int threads,
+                                       int grain) {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  if (!(widthbefore >= 0) || !(widthafter >= 0)) Rcpp::stop("Non-negative window widths needed.");
+  Rcpp::NumericVector res(values.size());
+  rolling_apply_index(kernel, values.begin(), index.get(), res.begin(), &widthbefore, &widthafter, &grain, &threads);
+  return res;
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here store the observation times of a dense
+//' series in a compact time index, and apply the rolling and SMA
+//' operators to it, so that repeated passes over the series read far
+//' less memory for the times.
+//'
+//' The index stores the difference of each observation time to the
+//' previous one in 2, 4 or 8 bytes, as needed for the largest
+//' difference, plus the absolute time of every 256th observation for
+//' random access. For tick data with gaps below 65536 time units, e.g.
+//' nanoseconds, this is about a quarter of the 8 bytes per observation
+//' of the times themselves. The operators process the series in chunks
+//' of \code{grain} observations, decoding the times of each chunk and
+//' of the observations within one window width around it into a buffer
+//' that stays in cache. The times of each chunk are relative to its
+//' first observation, so that the results equal those of the
+//' corresponding function (up to the rounding error of splitting the
+//' series into chunks, as for \code{threads}), and are exact for integer
+//' times as long as the observations used for a chunk span less than
+//' 2^53 time units.
+//' @title Compact time index for dense time series
+//' @param times A nanotime or integer64 vector, or a numeric vector of
+//' whole numbers, with non-decreasing observation times
+//' @return For \code{timeIndex}, an external pointer to the time index;
+//' for \code{timeIndexInfo}, a list with the number of observations,
+//' the bytes per time difference and the total size in bytes; for
+//' \code{rollingIndexed} and \code{SMAindexed}, a numeric vector with
+//' the result at each observation time.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingMean}}, \code{\link{SMAlast}}
+//' @examples
+//' times <- cumsum(sample(0:1000, 1e5, replace=TRUE))
+//' values <- rnorm(1e5)
+//' index <- timeIndex(times)
+//' timeIndexInfo(index)
+//' all.equal(rollingIndexed(index, values, 5000, 0, "mean"),
+//'           rollingMean(times, values, 5000, 0))
+//' all.equal(SMAindexed(index, values, 5000, 0, "linear"),
+//'           SMAlinear(times, values, 5000, 0))
+// [[Rcpp::export]]
+TimeIndex timeIndex(SEXP times) {
+  R_xlen_t n = XLENGTH(times);
+  std::vector<int64_t> ticks;
+  int64_t *t;
+  if (is_int64_times(times))
+    t = int64_times(times);  // rejects NA_integer64, whose differences to other times would overflow
+  else {
+    Rcpp::NumericVector x(times);
+    ticks.resize(n);
+    for (R_xlen_t i = 0; i < n; i++) {
+      if (!(fabs(x[i]) < 9.2e18) || x[i] != floor(x[i])) Rcpp::stop("Integer observation times needed.");
+      ticks[i] = (int64_t) x[i];
+    }
+    t = ticks.data();
+  }
+  time_index *index = new time_index;
+  int status = time_index_init(index, t, &n);
+  if (status != 0) {
+    delete index;
+    if (status == -2) Rcpp::stop("Observation time differences within the range of 64-bit integers needed.");
+    Rcpp::stop("Non-decreasing observation times needed.");
+  }
+  return TimeIndex(index, true);
+}
+
+//' @rdname timeIndex
+//' @param index An external pointer to a time index
+// [[Rcpp::export]]
+Rcpp::List timeIndexInfo(TimeIndex index) {
+  return Rcpp::List::create(Rcpp::Named("n") = (double) index->n,
+                            Rcpp::Named("deltaBytes") = index->delta_bytes,
+                            Rcpp::Named("bytes") = (double) time_index_bytes(index.get()));
+}
+
+//' @rdname timeIndex
+//' @param values A numeric vector
+//' @param widthbefore A double with the preceding observation width, in
+//' the unit of the times
+//' @param widthafter A double with the subsequent observation width, in
+//' the unit of the times
+//' @param stat A character string with the rolling operation, see
+//' \code{\link{rollingInto}}
+//' @param threads An integer with the number of threads used to process
+//' the chunks
+//' @param grain An integer with the number of observations per chunk, or
+//' zero for 4096; it should be large relative to the number of
+//' observations per window
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingIndexed(TimeIndex index,
+                                   Rcpp::NumericVector values,
+                                   TimeWidth widthbefore,
+                                   TimeWidth widthafter,
+                                   const std::string stat = "mean",
+                                   int threads = 1,
+                                   int grain = 0) {
+  return index_apply(rolling_kernel_named(stat), index, values, widthbefore, widthafter, threads, grain);
+}
+
+//' @rdname timeIndex
+//' @param type A character string, one of \code{"last"}, \code{"next"} or
+//' \code{"linear"}
+// [[Rcpp::export]]
+Rcpp::NumericVector SMAindexed(TimeIndex index,
+                               Rcpp::NumericVector values,
+                               TimeWidth widthbefore,
+                               TimeWidth widthafter,
+                               const std::string type = "last",
+                               int threads = 1,
+                               int grain = 0) {
+  return index_apply(sma_kernel_named(type), index, values, widthbefore, widthafter, threads, grain);
+}
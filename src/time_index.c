@@ -0,0 +1,256 @@
+// License: GPL-2 | GPL-3
+
+#include <math.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "time_index.h"
+
+
+/****************** BEGIN: Helper functions ****************/
+
+// Difference between the observation times at positions pos - 1 and pos
+static inline int64_t time_index_delta(time_index *index, ptrdiff_t pos)
+{
+  if (index->delta_bytes == 2)
+    return ((uint16_t *) index->deltas)[pos];
+  if (index->delta_bytes == 4)
+    return ((uint32_t *) index->deltas)[pos];
+  return ((int64_t *) index->deltas)[pos];
+}
+
+
+// Number of observations with a time before 'x', or at or before 'x' if 'inclusive' is non-zero
+static ptrdiff_t time_index_count(time_index *index, int64_t x, int inclusive)
+{
+  ptrdiff_t lo = 0, hi = (index->n - 1) / TIME_INDEX_STRIDE, mid, pos, end;
+  int64_t t;
+
+  // Trivial case
+  if ((index->n == 0) || (inclusive ? (index->checkpoints[0] > x) : (index->checkpoints[0] >= x)))
+    return 0;
+
+  // Last checkpoint before (or at) x
+  while (lo < hi) {
+    mid = lo + (hi - lo + 1) / 2;
+    t = index->checkpoints[mid];
+    if (inclusive ? (t <= x) : (t < x))
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  // Scan the observations after the checkpoint
+  pos = lo * TIME_INDEX_STRIDE;
+  end = (pos + TIME_INDEX_STRIDE < index->n) ? pos + TIME_INDEX_STRIDE : index->n;
+  t = index->checkpoints[lo];
+  while (pos + 1 < end) {
+    t += time_index_delta(index, pos + 1);
+    if (inclusive ? (t > x) : (t >= x))
+      break;
+    pos++;
+  }
+  return pos + 1;
+}
+
+
+// Shift a time by a width rounded away from it, saturating at the range of int64_t
+static int64_t time_shift(int64_t t, double width, int sign)
+{
+  double w = ceil(width) + 1;
+
+  if (w >= 9.2e18)
+    return (sign < 0) ? INT64_MIN : INT64_MAX;
+  if (sign < 0)
+    return (t < INT64_MIN + (int64_t) w) ? INT64_MIN : t - (int64_t) w;
+  return (t > INT64_MAX - (int64_t) w) ? INT64_MAX : t + (int64_t) w;
+}
+
+/****************** END: Helper functions ****************/
+
+
+// Build the time index of non-decreasing observation times, returning -1 (and an empty index) if they decrease,
+// or -2 if two consecutive times differ by more than INT64_MAX
+int time_index_init(time_index *index, int64_t times[], ptrdiff_t *n)
+{
+  // index ... time index
+  // times ... array of non-decreasing observation times
+  // n     ... number of observations, i.e. length of 'times'
+
+  ptrdiff_t num_checkpoints = (*n + TIME_INDEX_STRIDE - 1) / TIME_INDEX_STRIDE;
+  uint64_t max_delta = 0;
+
+  index->n = 0;
+  index->delta_bytes = 2;
+  index->checkpoints = NULL;
+  index->deltas = NULL;
+
+  // Size of the largest time difference, taken in unsigned arithmetic so that it cannot overflow
+  for (ptrdiff_t i = 1; i < *n; i++) {
+    if (times[i] < times[i-1])
+      return -1;
+    if ((uint64_t) times[i] - (uint64_t) times[i-1] > (uint64_t) INT64_MAX)
+      return -2;
+    if ((uint64_t) times[i] - (uint64_t) times[i-1] > max_delta)
+      max_delta = (uint64_t) times[i] - (uint64_t) times[i-1];
+  }
+  if (max_delta > UINT32_MAX)
+    index->delta_bytes = 8;
+  else if (max_delta > UINT16_MAX)
+    index->delta_bytes = 4;
+
+  // Store checkpoints and time differences
+  index->n = *n;
+  index->checkpoints = malloc((num_checkpoints > 0 ? num_checkpoints : 1) * sizeof(int64_t));
+  index->deltas = malloc((*n > 0 ? *n : 1) * index->delta_bytes);
+  for (ptrdiff_t k = 0; k < num_checkpoints; k++)
+    index->checkpoints[k] = times[k * TIME_INDEX_STRIDE];
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    int64_t delta = (i > 0) ? times[i] - times[i-1] : 0;
+    if (index->delta_bytes == 2)
+      ((uint16_t *) index->deltas)[i] = (uint16_t) delta;
+    else if (index->delta_bytes == 4)
+      ((uint32_t *) index->deltas)[i] = (uint32_t) delta;
+    else
+      ((int64_t *) index->deltas)[i] = delta;
+  }
+  return 0;
+}
+
+
+void time_index_free(time_index *index)
+{
+  free(index->checkpoints);
+  free(index->deltas);
+  index->checkpoints = NULL;
+  index->deltas = NULL;
+  index->n = 0;
+}
+
+
+// Memory used by the checkpoints and time differences
+size_t time_index_bytes(time_index *index)
+{
+  return (size_t) ((index->n + TIME_INDEX_STRIDE - 1) / TIME_INDEX_STRIDE) * sizeof(int64_t) +
+    (size_t) index->n * index->delta_bytes;
+}
+
+
+// Observation time at a position
+int64_t time_index_time(time_index *index, ptrdiff_t pos)
+{
+  // index ... time index
+  // pos   ... position between 0 and n - 1
+
+  ptrdiff_t first = pos - pos % TIME_INDEX_STRIDE;
+  int64_t t = index->checkpoints[pos / TIME_INDEX_STRIDE];
+
+  for (ptrdiff_t j = first + 1; j <= pos; j++)
+    t += time_index_delta(index, j);
+  return t;
+}
+
+
+// Decode consecutive observation times, relative to the first of them
+void time_index_decode(time_index *index, ptrdiff_t *start, ptrdiff_t *count, double times[])
+{
+  // index ... time index
+  // start ... position of the first observation
+  // count ... number of observations
+  // times ... array of length *count to store the observation times minus the time at position *start
+
+  int64_t t = 0;
+
+  // Trivial case
+  if (*count <= 0)
+    return;
+
+  // One loop per size of the time differences, so that the loops can be unrolled and pipelined
+  times[0] = 0;
+  if (index->delta_bytes == 2) {
+    uint16_t *d = (uint16_t *) index->deltas + *start;
+    for (ptrdiff_t j = 1; j < *count; j++) {
+      t += d[j];
+      times[j] = (double) t;
+    }
+  } else if (index->delta_bytes == 4) {
+    uint32_t *d = (uint32_t *) index->deltas + *start;
+    for (ptrdiff_t j = 1; j < *count; j++) {
+      t += d[j];
+      times[j] = (double) t;
+    }
+  } else {
+    int64_t *d = (int64_t *) index->deltas + *start;
+    for (ptrdiff_t j = 1; j < *count; j++) {
+      t += d[j];
+      times[j] = (double) t;
+    }
+  }
+}
+
+
+/*
+Rolling or SMA kernel applied to the observation times of a time index
+-) as in rolling_apply_parallel, the output values are computed in chunks, each using the observations from the
+   last one before the rolling window of its first output value to the first one after the rolling window of its
+   last output value; here the chunk boundaries are found with the checkpoints, and the times of each chunk are
+   decoded into a buffer relative to its first observation
+-) the chunks can be processed in parallel as in rolling_apply_parallel
+*/
+void rolling_apply_index(rolling_kernel kernel, double values[], time_index *index, double values_new[],
+  double *width_before, double *width_after, int *grain_size, int *num_threads)
+{
+  // kernel       ... rolling or SMA kernel, e.g. rolling_mean or sma_linear
+  // values       ... array of time series values
+  // index        ... time index of the observation times
+  // values_new   ... array of length index->n to store output time series values
+  // width_before ... (non-negative) width of rolling window before t_i, in the unit of the observation times
+  // width_after  ... (non-negative) width of rolling window after t_i, in the unit of the observation times
+  // grain_size   ... number of output values per chunk (if non-positive, TIME_INDEX_GRAIN)
+  // num_threads  ... number of threads
+
+  ptrdiff_t n = index->n, grain, num_chunks;
+  int threads = (*num_threads < 1) ? 1 : *num_threads;
+
+  // Trivial case
+  if (n == 0)
+    return;
+
+  // Use no more threads than available
+#ifdef _OPENMP
+  if (threads > omp_get_max_threads())
+    threads = omp_get_max_threads();
+#endif
+
+  // Determine the chunk size
+  grain = (*grain_size > 0) ? *grain_size : TIME_INDEX_GRAIN;
+  num_chunks = (n + grain - 1) / grain;
+
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (ptrdiff_t k = 0; k < num_chunks; k++) {
+    ptrdiff_t start = k * grain, end = (start + grain < n) ? start + grain : n;
+    ptrdiff_t lo, hi, len;
+    double *times, *out;
+
+    // Last observation before the rolling window of the first output value, and first observation after the
+    // rolling window of the last output value; the widths are rounded up, which can only add observations
+    lo = time_index_count(index, time_shift(time_index_time(index, start), *width_before, -1), 0) - 1;
+    if (lo < 0)
+      lo = 0;
+    hi = time_index_count(index, time_shift(time_index_time(index, end - 1), *width_after, 1), 1);
+    if (hi > n - 1)
+      hi = n - 1;
+
+    // Apply the kernel to the subseries and keep the output for the chunk
+    len = hi - lo + 1;
+    times = malloc(len * sizeof(double));
+    out = malloc(len * sizeof(double));
+    time_index_decode(index, &lo, &len, times);
+    kernel(values + lo, times, &len, out, width_before, width_after);
+    for (ptrdiff_t pos = start; pos < end; pos++)
+      values_new[pos] = out[pos - lo];
+    free(times);
+    free(out);
+  }
+}
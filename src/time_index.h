@@ -0,0 +1,45 @@
+// License: GPL-2 | GPL-3
+// Remark: To facilitate interfaces to other programming languages such as R, all variables are either pointers or arrays
+
+#ifndef _time_index_h
+#define _time_index_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rolling.h"
+
+// Number of observations between two checkpoints of a time index
+#define TIME_INDEX_STRIDE 256
+
+// Default number of output values per chunk of rolling_apply_index
+#define TIME_INDEX_GRAIN 4096
+
+/*
+Compact time index of non-decreasing integer observation times, e.g. nanoseconds since the epoch
+-) the times are stored as the differences to the previous observation time, in 2, 4 or 8 bytes each as needed
+   for the largest difference, and as absolute checkpoints every TIME_INDEX_STRIDE observations, so that a dense
+   series takes about a quarter of the memory of its times, and any time is decoded in O(TIME_INDEX_STRIDE)
+-) rolling_apply_index applies a rolling or SMA kernel in chunks of observations, decoding the times of each
+   chunk and the observations within one window width of its boundaries into a buffer that stays in cache, so
+   that the observation times are read from memory in compressed form only
+-) the decoded times are relative to the first observation of each chunk, so that they are exact as long as the
+   observations used for a chunk span less than 2^53 time units; the results then agree with applying the kernel
+   to the times themselves, up to the rounding error of rolling_apply_parallel
+*/
+typedef struct {
+  ptrdiff_t n;                  // number of observations
+  int delta_bytes;              // size of each time difference, 2, 4 or 8
+  int64_t *checkpoints;         // times of the observations at positions 0, TIME_INDEX_STRIDE, 2 * TIME_INDEX_STRIDE, ...
+  void *deltas;                 // differences to the previous observation time, starting at position 1
+} time_index;
+
+int time_index_init(time_index *index, int64_t times[], ptrdiff_t *n);
+void time_index_free(time_index *index);
+size_t time_index_bytes(time_index *index);
+int64_t time_index_time(time_index *index, ptrdiff_t pos);
+void time_index_decode(time_index *index, ptrdiff_t *start, ptrdiff_t *count, double times[]);
+
+void rolling_apply_index(rolling_kernel kernel, double values[], time_index *index, double values_new[],
+  double *width_before, double *width_after, int *grain_size, int *num_threads);
+
+#endif
@@ -0,0 +1,273 @@
+#include <Rcpp.h>
+#include <vector>
+
+#include "RcppUTS_types.h"
+#include "int64_times.h"
+#include "kernel_names.h"
+#include "rolling_summary.h"
+#include <RcppUTS/time_window.h>
+
+// Rolling windows of a window index whose window ends are stored as 'Offset', see <RcppUTS/time_window.h>
+template <class Offset>
+struct index_windows {
+  explicit index_windows(window_index *index)
+    : left(static_cast<Offset*>(index->left)), right(static_cast<Offset*>(index->right)) {}
+
+  bool includes_right(ptrdiff_t pos, ptrdiff_t i) const { return pos - i <= right[i]; }
+  bool excludes_left(ptrdiff_t pos, ptrdiff_t i) const { return pos - i < left[i]; }
+
+  const Offset *left, *right;
+};
+
+// Apply the fused rolling summary kernel to the windows of a window index
+static void summary_windowed(int mask, window_index *index, double *values, double *out) {
+  ptrdiff_t n = index->n;
+  if (index->offset_bytes == 2)
+    rolling_summary_dispatch<SUMMARY_ALL>::run(mask, values, &n, &n, out, index_windows<int16_t>(index));
+  else if (index->offset_bytes == 4)
+    rolling_summary_dispatch<SUMMARY_ALL>::run(mask, values, &n, &n, out, index_windows<int32_t>(index));
+  else
+    rolling_summary_dispatch<SUMMARY_ALL>::run(mask, values, &n, &n, out, index_windows<int64_t>(index));
+}
+
+// Apply the sliding-window aggregation of the operation 'op' to the windows of a window index
+static void aggregate_windowed(const std::string& op, window_index *index, double *values, double *out) {
+  if (index->offset_bytes == 2)
+    rolling_aggregate_named(op, values, index->n, out, index_windows<int16_t>(index));
+  else if (index->offset_bytes == 4)
+    rolling_aggregate_named(op, values, index->n, out, index_windows<int32_t>(index));
+  else
+    rolling_aggregate_named(op, values, index->n, out, index_windows<int64_t>(index));
+}
+
+//' The UTS library by Andreas Eckner provides algorithms for unevenly
+//' spaced time-series data.  This package brings a few of them to R.
+//' The functions describe here determine the rolling windows of a series
+//' once, and then apply rolling statistics and SMA operators to any
+//' number of value vectors observed at the same times, without
+//' searching the observation times for the window ends again.
+//'
+//' The index stores the positions of the first and last observation of
+//' each window relative to the observation itself, in 2, 4 or 8 bytes
+//' as needed for the largest window, i.e. 4 bytes per observation for
+//' windows of up to 32767 observations. The windows are those of the
+//' corresponding functions, including the limits on the number of
+//' observations of \code{\link{rollingSummary}}, so that the results are
+//' identical to those of \code{\link{rollingSummary}},
+//' \code{\link{rollingAggregate}}, \code{\link{SMAlast}} and its
+//' variants, and of the rolling operators such as \code{\link{rollingMean}}
+//' and \code{\link{rollingQuantile}} for the same times and widths. The SMA
+//' operators also need the observation times for the areas, as a Datetime
+//' or numeric vector, and an index without limits on the number of
+//' observations.
+//'
+//' \code{rollingPairWindowed} pairs the two value vectors by position, as
+//' both are observed at the times of the index; this equals the as-of
+//' alignment of \code{\link{rollingCov}} for distinct times. The buckets of
+//' \code{rollingQuantileApproxWindowed} hold consecutive observations
+//' instead of time spans, with \code{buckets} of them to the longest
+//' window, since the index does not keep the times.
+//' @title Precomputed rolling windows for irregularly spaced time series
+//' @param times A Datetime vector, or a nanotime or integer64 vector with
+//' integer times, with non-decreasing observation times
+//' @param widthbefore A double, or an integer64 value such as a
+//' nanoduration, with the preceding observation width, in the unit of the
+//' times (i.e. whole nanoseconds for nanotime)
+//' @param widthafter A double with the subsequent observation width
+//' @param nbefore A double with the maximum number of preceding
+//' observations in the rolling window, by default unlimited
+//' @param nafter A double with the maximum number of subsequent
+//' observations in the rolling window, by default unlimited
+//' @return For \code{windowIndex}, an external pointer to the window
+//' index; for \code{windowIndexInfo}, a list with the number of
+//' observations, the bytes per window end, the total size in bytes and
+//' the window widths; for \code{rollingSummaryWindowed}, a numeric matrix
+//' as for \code{\link{rollingSummary}}; for \code{rollingQuantileWindowed}
+//' and \code{rollingQuantileApproxWindowed}, a numeric matrix as for
+//' \code{\link{rollingQuantile}}; for the other functions, a numeric vector
+//' with the result at each observation time.
+//' @author Dirk Eddelbuettel for the package, Andreas Eckner for the
+//' underlying code.
+//' @seealso \code{\link{rollingSummary}}, \code{\link{timeIndex}}
+//' @examples
+//' times <- cumsum(rexp(1e4))
+//' x <- rnorm(1e4)
+//' y <- rnorm(1e4)
+//' index <- windowIndex(times, 50, 0)
+//' windowIndexInfo(index)
+//' all.equal(rollingSummaryWindowed(index, x, c("mean", "max")),
+//'           rollingSummary(times, x, 50, 0, c("mean", "max")))
+//' all.equal(rollingAggregateWindowed(index, y, "min"),
+//'           rollingAggregate(times, y, 50, 0, "min"))
+//' all.equal(SMAwindowed(index, times, y, "linear"),
+//'           SMAlinear(times, y, 50, 0))
+//' all.equal(rollingWindowed(index, y, "median"),
+//'           rollingMedian(times, y, 50, 0))
+//' all.equal(rollingPairWindowed(index, x, y, "cor"),
+//'           rollingCor(times, x, times, y, 50, 0))
+// [[Rcpp::export]]
+WindowIndex windowIndex(SEXP times,
+                        TimeWidth widthbefore,
+                        TimeWidth widthafter,
+                        const double nbefore = R_PosInf,
+                        const double nafter = R_PosInf) {
+  if (!(widthbefore >= 0) || !(widthafter >= 0)) Rcpp::stop("Non-negative window widths needed.");
+  if (!(nbefore >= 0) || !(nafter >= 0)) Rcpp::stop("Non-negative observation counts needed.");
+  R_xlen_t n = XLENGTH(times);
+  R_xlen_t nb = (nbefore < n) ? (R_xlen_t) nbefore : n, na = (nafter < n) ? (R_xlen_t) nafter : n;
+  std::vector<ptrdiff_t> left(n), right(n);
+  if (is_int64_times(times)) {
+    int64_t wb = widthbefore.int64(), wa = widthafter.int64();
+    window_bounds(time_windows<int64_t>(int64_times(times), int64_times(times), &wb, &wa, &nb, &na),
+                  &n, &n, left.data(), right.data());
+  } else {
+    Rcpp::DatetimeVector t(times);
+    window_bounds(time_windows<double>(t.begin(), t.begin(), widthbefore.ptr(), widthafter.ptr(), &nb, &na),
+                  &n, &n, left.data(), right.data());
+  }
+  window_index *index = new window_index;
+  window_index_init(index, left.data(), right.data(), &n);
+  index->width_before = widthbefore;
+  index->width_after = widthafter;
+  index->limited = (nb < n) || (na < n);
+  return WindowIndex(index, true);
+}
+
+//' @rdname windowIndex
+//' @param index An external pointer to a window index
+// [[Rcpp::export]]
+Rcpp::List windowIndexInfo(WindowIndex index) {
+  return Rcpp::List::create(Rcpp::Named("n") = (double) index->n,
+                            Rcpp::Named("offsetBytes") = index->offset_bytes,
+                            Rcpp::Named("bytes") = (double) window_index_bytes(index.get()),
+                            Rcpp::Named("widthbefore") = index->width_before,
+                            Rcpp::Named("widthafter") = index->width_after,
+                            Rcpp::Named("limited") = (index->limited != 0));
+}
+
+//' @rdname windowIndex
+//' @param values A numeric vector
+//' @param stats A character vector with the requested statistics, see
+//' \code{\link{rollingSummary}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingSummaryWindowed(WindowIndex index,
+                                           Rcpp::NumericVector values,
+                                           Rcpp::CharacterVector stats = Rcpp::CharacterVector::create("nobs", "sum", "mean", "var", "min", "max")) {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  int mask = summary_stats_named(stats);
+  Rcpp::NumericMatrix res = summary_matrix(values.size(), mask);
+  summary_windowed(mask, index.get(), values.begin(), res.begin());
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param op A character string with the operation, see
+//' \code{\link{rollingAggregate}}
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingAggregateWindowed(WindowIndex index,
+                                             Rcpp::NumericVector values,
+                                             const std::string op = "sum") {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  Rcpp::NumericVector res(values.size());
+  aggregate_windowed(op, index.get(), values.begin(), res.begin());
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param type A character string, one of \code{"last"}, \code{"next"} or
+//' \code{"linear"}
+// [[Rcpp::export]]
+Rcpp::NumericVector SMAwindowed(WindowIndex index,
+                                SEXP times,
+                                Rcpp::NumericVector values,
+                                const std::string type = "last") {
+  if (XLENGTH(times) != index->n || values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  if (is_int64_times(times)) Rcpp::stop("Numeric observation times needed.");
+  if (index->limited) Rcpp::stop("Window index without observation limits needed.");
+  sma_window_kernel kernel = sma_window_kernel_named(type);
+  Rcpp::DatetimeVector t(times);
+  Rcpp::NumericVector res(values.size());
+  kernel(values.begin(), t.begin(), index.get(), res.begin(), &index->width_before, &index->width_after);
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param stat A character string with the rolling operation, see
+//' \code{\link{rollingInto}}; for \code{rollingPairWindowed}, one of
+//' \code{"cov"}, \code{"cor"} or \code{"beta"}
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingWindowed(WindowIndex index,
+                                    Rcpp::NumericVector values,
+                                    const std::string stat = "mean") {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  rolling_window_kernel kernel = rolling_window_kernel_named(stat);
+  Rcpp::NumericVector res(values.size());
+  kernel(values.begin(), index.get(), res.begin());
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param moment A double with the order of the central moment
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingCentralMomentWindowed(WindowIndex index,
+                                                 Rcpp::NumericVector values,
+                                                 const double moment) {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  Rcpp::NumericVector res(values.size());
+  rolling_central_moment_window(values.begin(), index.get(), res.begin(), const_cast<double*>(&moment));
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param probs A numeric vector with probabilities between zero and one
+//' @param quantiletype An integer between 1 and 9 selecting the quantile
+//' definition, as in \code{\link[stats]{quantile}}
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingQuantileWindowed(WindowIndex index,
+                                            Rcpp::NumericVector values,
+                                            Rcpp::NumericVector probs,
+                                            int quantiletype = 7) {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  if (quantiletype < 1 || quantiletype > 9) Rcpp::stop("Quantile type must be between 1 and 9.");
+  int k = probs.size();
+  Rcpp::NumericMatrix res(values.size(), k);
+  res.attr("dimnames") = Rcpp::List::create(R_NilValue, quantile_names(probs));
+  rolling_quantile_window(values.begin(), index.get(), res.begin(), probs.begin(), &k, &quantiletype);
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param compression A double with the accuracy parameter of the
+//' t-digests, see \code{\link{rollingQuantileApprox}}
+//' @param buckets An integer with the number of buckets per longest window
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rollingQuantileApproxWindowed(WindowIndex index,
+                                                  Rcpp::NumericVector values,
+                                                  Rcpp::NumericVector probs,
+                                                  double compression = 100,
+                                                  int buckets = 32) {
+  if (values.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  if (buckets < 1) Rcpp::stop("At least one bucket needed.");
+  int k = probs.size();
+  Rcpp::NumericMatrix res(values.size(), k);
+  res.attr("dimnames") = Rcpp::List::create(R_NilValue, quantile_names(probs));
+  rolling_quantile_approx_window(values.begin(), index.get(), res.begin(), probs.begin(), &k,
+                                 &compression, &buckets);
+  return res;
+}
+
+//' @rdname windowIndex
+//' @param valuesx A numeric vector with the values of the first series
+//' @param valuesy A numeric vector with the values of the second series,
+//' observed at the same times
+// [[Rcpp::export]]
+Rcpp::NumericVector rollingPairWindowed(WindowIndex index,
+                                        Rcpp::NumericVector valuesx,
+                                        Rcpp::NumericVector valuesy,
+                                        const std::string stat = "cov") {
+  if (valuesx.size() != index->n || valuesy.size() != index->n) Rcpp::stop("Matching vectors needed.");
+  rolling_pair_window_kernel kernel = rolling_pair_window_kernel_named(stat);
+  Rcpp::NumericVector res(valuesx.size());
+  kernel(valuesx.begin(), valuesy.begin(), index.get(), res.begin());
+  return res;
+}
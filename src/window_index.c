@@ -0,0 +1,82 @@
+// License: GPL-2 | GPL-3
+
+#include <stdlib.h>
+#include "window_index.h"
+
+
+/****************** BEGIN: Helper functions ****************/
+
+// Store a window end relative to its observation
+static inline void window_index_store(void *ends, int bytes, ptrdiff_t pos, ptrdiff_t offset)
+{
+  if (bytes == 2)
+    ((int16_t *) ends)[pos] = (int16_t) offset;
+  else if (bytes == 4)
+    ((int32_t *) ends)[pos] = (int32_t) offset;
+  else
+    ((int64_t *) ends)[pos] = (int64_t) offset;
+}
+
+
+/****************** END: Helper functions ****************/
+
+
+// Build the window index from the positions of the first and last observation in each window
+void window_index_init(window_index *index, ptrdiff_t left[], ptrdiff_t right[], ptrdiff_t *n)
+{
+  // index ... window index
+  // left  ... array of the position of the first observation in each window, e.g. from rolling_window_bounds
+  // right ... array of the position of the last observation in each window
+  // n     ... number of windows, i.e. length of 'left' and 'right'
+
+  ptrdiff_t max_offset = 0, offset;
+
+  // Size of the largest window end relative to its observation
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    offset = (left[i] > i) ? left[i] - i : i - left[i];
+    if (offset > max_offset)
+      max_offset = offset;
+    offset = (right[i] > i) ? right[i] - i : i - right[i];
+    if (offset > max_offset)
+      max_offset = offset;
+  }
+  if (max_offset > INT32_MAX)
+    index->offset_bytes = 8;
+  else if (max_offset > INT16_MAX)
+    index->offset_bytes = 4;
+  else
+    index->offset_bytes = 2;
+
+  // Store the window ends
+  index->n = *n;
+  index->num_obs = *n;
+  index->left = malloc((*n > 0 ? *n : 1) * index->offset_bytes);
+  index->right = malloc((*n > 0 ? *n : 1) * index->offset_bytes);
+  for (ptrdiff_t i = 0; i < *n; i++) {
+    window_index_store(index->left, index->offset_bytes, i, left[i] - i);
+    window_index_store(index->right, index->offset_bytes, i, right[i] - i);
+  }
+
+  // Set by the caller, as well as 'num_obs' for the windows of query times
+  index->width_before = 0;
+  index->width_after = 0;
+  index->limited = 0;
+}
+
+
+void window_index_free(window_index *index)
+{
+  free(index->left);
+  free(index->right);
+  index->left = NULL;
+  index->right = NULL;
+  index->n = 0;
+  index->num_obs = 0;
+}
+
+
+// Memory used by the window ends
+size_t window_index_bytes(window_index *index)
+{
+  return 2 * (size_t) index->n * index->offset_bytes;
+}
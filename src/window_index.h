@@ -0,0 +1,68 @@
+// License: GPL-2 | GPL-3
+// Remark: To facilitate interfaces to other programming languages such as R, all variables are either pointers or arrays
+
+#ifndef _window_index_h
+#define _window_index_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Precomputed rolling windows of the observation times of a time series
+-) the window of observation i consists of the observations at positions left_i to right_i, as determined by
+   rolling_window_bounds or rolling_window_bounds_capped; both are stored relative to i, in 2, 4 or 8 bytes each
+   as needed for the largest window, e.g. in 4 bytes per observation for windows of up to 32767 observations
+-) the windows depend only on the observation times and the window widths, so that the index is built once and
+   then used for any number of statistics and value columns, none of which searches the times for the window ends
+-) the widths are kept for the kernels that also need them, e.g. the SMA kernels
+-) the windows can also be those of query times other than the observation times, e.g. of a regular time grid,
+   in which case window i is that of the i-th query time, and 'num_obs' is the number of observations
+*/
+typedef struct {
+  ptrdiff_t n;                  // number of windows, i.e. of observations or query times
+  ptrdiff_t num_obs;            // number of observations the windows are taken from
+  int offset_bytes;             // size of each window end relative to its observation, 2, 4 or 8
+  void *left;                   // position of the first observation in each window minus the position i
+  void *right;                  // position of the last observation in each window minus the position i
+  double width_before;          // width of the rolling windows before t_i
+  double width_after;           // width of the rolling windows after t_i
+  int limited;                  // non-zero if the windows are further limited by a number of observations
+} window_index;
+
+void window_index_init(window_index *index, ptrdiff_t left[], ptrdiff_t right[], ptrdiff_t *n);
+void window_index_free(window_index *index);
+size_t window_index_bytes(window_index *index);
+
+
+// Window end relative to its observation
+static inline ptrdiff_t window_index_load(void *ends, int bytes, ptrdiff_t pos)
+{
+  if (bytes == 2)
+    return ((int16_t *) ends)[pos];
+  if (bytes == 4)
+    return ((int32_t *) ends)[pos];
+  return (ptrdiff_t) ((int64_t *) ends)[pos];
+}
+
+
+// Position of the first observation in the window of an observation
+// -) inline, as the rolling kernels call it in their innermost loops
+static inline ptrdiff_t window_index_left(window_index *index, ptrdiff_t pos)
+{
+  // index ... window index
+  // pos   ... window between 0 and n - 1
+
+  return pos + window_index_load(index->left, index->offset_bytes, pos);
+}
+
+
+// Position of the last observation in the window of an observation
+static inline ptrdiff_t window_index_right(window_index *index, ptrdiff_t pos)
+{
+  // index ... window index
+  // pos   ... window between 0 and n - 1
+
+  return pos + window_index_load(index->right, index->offset_bytes, pos);
+}
+
+#endif